@@ -0,0 +1,45 @@
+#ifndef BENCH_CONTEXT_H
+#define BENCH_CONTEXT_H
+
+#include <cstring>
+#include <iostream>
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+// creates an invisible window with a current GL 3.3 core context, as the game's --headless mode does.
+// --osmesa in argv creates the context through OSMesa, for machines without a display
+inline GLFWwindow* CreateBenchContext(int argc, char** argv) {
+    bool osmesa = false;
+    for(int i = 1; i < argc; i++)
+        osmesa |= std::strcmp(argv[i], "--osmesa") == 0;
+
+    if(osmesa)
+        glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_NULL);
+    glfwInit();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+#ifdef __APPLE__
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#endif
+    glfwWindowHint(GLFW_VISIBLE, false);
+    if(osmesa)
+        glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_OSMESA_CONTEXT_API);
+
+    GLFWwindow* window = glfwCreateWindow(64, 64, "bench", nullptr, nullptr);
+    if(!window) {
+        std::cout << "Failed to create GLFW window" << std::endl;
+        glfwTerminate();
+        return nullptr;
+    }
+    glfwMakeContextCurrent(window);
+    if(!gladLoadGLLoader((GLADloadproc) glfwGetProcAddress)) {
+        std::cout << "Failed to initialize GLAD" << std::endl;
+        glfwTerminate();
+        return nullptr;
+    }
+    return window;
+}
+
+#endif
@@ -0,0 +1,92 @@
+// Randomized check and timing of BrickBVH: random free-form bricks are destroyed one by one
+// (each followed by a Refit) between random queries. Every query has to return all live
+// bricks overlapping its box in ascending order, compared against a brute force scan.
+// usage: bench_brick_bvh [bricks] [queries]
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "brick_bvh.h"
+#include "brick_store.h"
+
+const glm::vec2 AREA(800.0f, 300.0f);
+// one brick is destroyed every this many queries
+const unsigned int DESTROY_EVERY = 4;
+
+bool overlaps(const BrickInstance& brick, glm::vec2 min, glm::vec2 max) {
+    return brick.Position.x <= max.x && brick.Position.x + brick.Size.x >= min.x
+        && brick.Position.y <= max.y && brick.Position.y + brick.Size.y >= min.y;
+}
+
+int main(int argc, char** argv) {
+    unsigned int count = argc > 1 ? std::atoi(argv[1]) : 10000;
+    unsigned int queries = argc > 2 ? std::atoi(argv[2]) : 20000;
+
+    // small bricks of any size, every 17th one solid, placed as a free-form level places them
+    std::mt19937 random(3);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    BrickStore bricks;
+    for(unsigned int i = 0; i < count; i++) {
+        glm::vec2 size(2.0f + unit(random) * 12.0f, 2.0f + unit(random) * 6.0f);
+        glm::vec2 position = glm::vec2(unit(random), unit(random)) * (AREA - size);
+        bricks.Add(position, size, 2 + i % 4, i % 17 == 0);
+    }
+    BrickBVH tree;
+    std::vector<unsigned int> order;
+    auto start = std::chrono::steady_clock::now();
+    tree.Build(bricks, order);
+    bricks.Reorder(order);
+    bricks.Build();
+    double build = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    std::vector<unsigned int> found, expected;
+    double queryTime = 0.0, refitTime = 0.0, bruteTime = 0.0;
+    unsigned int refits = 0, errors = 0;
+    size_t candidates = 0;
+    for(unsigned int q = 0; q < queries; q++) {
+        if(q % DESTROY_EVERY == 0) {
+            unsigned int brick = random() % bricks.Size();
+            if(bricks.Live.Test(brick) && !bricks.Solid.Test(brick)) {
+                start = std::chrono::steady_clock::now();
+                bricks.Destroy(brick);
+                tree.Refit(bricks, brick);
+                refitTime += std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+                refits++;
+            }
+        }
+
+        // about the box a ball sweeps over in a step
+        glm::vec2 min = glm::vec2(unit(random), unit(random)) * (AREA + 40.0f) - 20.0f;
+        glm::vec2 max = min + glm::vec2(25.0f + unit(random) * 10.0f);
+        start = std::chrono::steady_clock::now();
+        tree.Query(min, max, found);
+        queryTime += std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+        candidates += found.size();
+
+        start = std::chrono::steady_clock::now();
+        expected.clear();
+        for(unsigned int i = 0; i < bricks.Size(); i++)
+            if(bricks.Live.Test(i) && overlaps(bricks.Instances[i], min, max))
+                expected.push_back(i);
+        bruteTime += std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+
+        if(!std::is_sorted(found.begin(), found.end()))
+            errors++;
+        for(unsigned int brick : expected)
+            if(!std::binary_search(found.begin(), found.end(), brick))
+                errors++;
+    }
+
+    std::printf("%u bricks, %u queries, %u destroyed\n", count, queries, refits);
+    std::printf("build        %8.3f ms\n", build);
+    std::printf("query        %8.3f us  %.1f candidates\n", queryTime / queries, double(candidates) / queries);
+    std::printf("brute force  %8.3f us\n", bruteTime / queries);
+    std::printf("refit        %8.3f us\n", refits ? refitTime / refits : 0.0);
+    std::printf("errors       %u\n", errors);
+    return errors ? 1 : 0;
+}
@@ -0,0 +1,142 @@
+// Brick candidate loop of Game::MoveBall over the two brick layouts: a vector of GameObject
+// bricks as GameLevel kept them before BrickStore, and the BrickStore components. Balls are
+// placed at random over a dense grid level, each one reads the bricks on the tiles around
+// it: the live flag of every candidate, the bounds for the contact test and the box of
+// every live candidate for the sweep.
+// usage: bench_brick_layout [columns] [rows] [balls]
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "box_collision.h"
+#include "brick_store.h"
+
+const glm::vec2 TILE(20.0f, 10.0f);
+const float BALL_RADIUS = 12.5f;
+// the part of a step's motion a ball covers, so the candidates span a few tiles
+const glm::vec2 BALL_MOTION(4.0f, -6.0f);
+
+// a brick as it was stored before BrickStore, the GameObject of that time
+class OldBrick {
+public:
+    glm::vec2 Position, Size, Velocity;
+    glm::vec2 PreviousPosition;
+    glm::vec3 Color;
+    float Rotation;
+    bool IsSolid;
+    bool Destroyed;
+    unsigned int Sprite;
+
+    virtual ~OldBrick() {}
+    virtual void Draw() {}
+};
+
+// the entry time of the ball into the box grown by its radius, the slab part of Game::SweepCollision
+float sweep(glm::vec2 center, glm::vec2 motion, glm::vec2 position, glm::vec2 size) {
+    glm::vec2 t0 = (position - BALL_RADIUS - center) / motion;
+    glm::vec2 t1 = (position + size + BALL_RADIUS - center) / motion;
+    glm::vec2 enter = glm::min(t0, t1), exit = glm::max(t0, t1);
+    float first = std::max(enter.x, enter.y), last = std::min(exit.x, exit.y);
+    return first <= last && first >= 0.0f && first <= 1.0f ? first : 1.0f;
+}
+
+// the bricks on the tiles the box [min, max] covers, as GameLevel::QueryBricks returns them
+void queryTiles(glm::vec2 min, glm::vec2 max, unsigned int columns, unsigned int rows, std::vector<unsigned int>& out) {
+    out.clear();
+    int x0 = std::max(0, int(min.x / TILE.x)), x1 = std::min(int(columns) - 1, int(max.x / TILE.x));
+    int y0 = std::max(0, int(min.y / TILE.y)), y1 = std::min(int(rows) - 1, int(max.y / TILE.y));
+    for(int y = y0; y <= y1; y++)
+        for(int x = x0; x <= x1; x++)
+            out.push_back(y * columns + x);
+}
+
+int main(int argc, char** argv) {
+    unsigned int columns = argc > 1 ? std::atoi(argv[1]) : 400;
+    unsigned int rows = argc > 2 ? std::atoi(argv[2]) : 400;
+    unsigned int balls = argc > 3 ? std::atoi(argv[3]) : 200000;
+    unsigned int count = columns * rows;
+
+    // a third of the bricks destroyed, every 13th one solid
+    std::mt19937 random(5);
+    std::vector<OldBrick> old(count);
+    BrickStore bricks;
+    for(unsigned int i = 0; i < count; i++) {
+        glm::vec2 position = glm::vec2(i % columns, i / columns) * TILE;
+        old[i].Position = old[i].PreviousPosition = position;
+        old[i].Size = TILE;
+        old[i].IsSolid = i % 13 == 0;
+        old[i].Destroyed = false;
+        bricks.Add(position, TILE, 2, old[i].IsSolid);
+    }
+    bricks.Build();
+    for(unsigned int i = 0; i < count; i++)
+        if(!old[i].IsSolid && random() % 3 == 0) {
+            old[i].Destroyed = true;
+            bricks.Destroy(i);
+        }
+
+    std::uniform_real_distribution<float> x(0.0f, columns * TILE.x), y(0.0f, rows * TILE.y);
+    std::vector<glm::vec2> positions(balls);
+    for(glm::vec2& position : positions)
+        position = glm::vec2(x(random), y(random));
+    std::vector<unsigned int> candidates;
+
+    // the old loop reads each candidate's GameObject for its flag and its box
+    float oldSum = 0.0f;
+    unsigned int oldContacts = 0;
+    auto start = std::chrono::steady_clock::now();
+    for(glm::vec2 position : positions) {
+        glm::vec2 center = position + BALL_RADIUS;
+        queryTiles(glm::min(position, position + BALL_MOTION), glm::max(position, position + BALL_MOTION) + BALL_RADIUS * 2.0f, columns, rows, candidates);
+        CircleContacts<SIMD_WIDTH> contacts;
+        unsigned int contactsFirst = -1;
+        for(unsigned int i : candidates) {
+            const OldBrick& brick = old[i];
+            if(brick.Destroyed)
+                continue;
+            unsigned int lane = i % SIMD_WIDTH;
+            if(i - lane != contactsFirst) {
+                contactsFirst = i - lane;
+                contacts = CollideCircle<SIMD_WIDTH>(bricks.Bounds, contactsFirst, center, BALL_RADIUS);
+            }
+            oldContacts += (contacts.Mask >> lane) & 1;
+            oldSum += sweep(center, BALL_MOTION, brick.Position, brick.Size);
+        }
+    }
+    double oldTime = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+    // the new loop reads the live bits, and the instance only of the live candidates
+    float newSum = 0.0f;
+    unsigned int newContacts = 0;
+    start = std::chrono::steady_clock::now();
+    for(glm::vec2 position : positions) {
+        glm::vec2 center = position + BALL_RADIUS;
+        queryTiles(glm::min(position, position + BALL_MOTION), glm::max(position, position + BALL_MOTION) + BALL_RADIUS * 2.0f, columns, rows, candidates);
+        CircleContacts<SIMD_WIDTH> contacts;
+        unsigned int contactsFirst = -1;
+        for(unsigned int i : candidates) {
+            if(!bricks.Live.Test(i))
+                continue;
+            unsigned int lane = i % SIMD_WIDTH;
+            if(i - lane != contactsFirst) {
+                contactsFirst = i - lane;
+                contacts = CollideCircle<SIMD_WIDTH>(bricks.Bounds, contactsFirst, center, BALL_RADIUS);
+            }
+            newContacts += (contacts.Mask >> lane) & 1;
+            const BrickInstance& brick = bricks.Instances[i];
+            newSum += sweep(center, BALL_MOTION, brick.Position, brick.Size);
+        }
+    }
+    double newTime = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+    std::printf("%u x %u bricks, %u balls\n", columns, rows, balls);
+    std::printf("GameObject bricks  %4zu bytes/brick  %7.1f ns/ball  contacts %u\n", sizeof(OldBrick), oldTime / balls, oldContacts);
+    std::printf("BrickStore         %4zu bytes/brick  %7.1f ns/ball  contacts %u\n",
+        sizeof(BrickInstance) + 4 * sizeof(float), newTime / balls, newContacts);
+    return oldContacts == newContacts && oldSum == newSum ? 0 : 1;
+}
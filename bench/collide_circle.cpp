@@ -0,0 +1,120 @@
+// Microbenchmark of the circle vs box test: the scalar CheckCollision + VectorDirection
+// loop the ball used before BoxBounds, against CollideCircle at widths 1, 4 and 8.
+// usage: bench_collide_circle [boxes] [circles]
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "box_collision.h"
+
+const float BALL_RADIUS = 12.5f;
+// every n-th box is cleared, like destroyed bricks
+const unsigned int CLEARED_EVERY = 7;
+
+// the old Game::VectorDirection, the compass direction closest to target
+int vectorDirection(glm::vec2 target) {
+    const glm::vec2 compass[] = {
+        glm::vec2(0.0f, 1.0f),  // up
+        glm::vec2(1.0f, 0.0f),  // right
+        glm::vec2(0.0f, -1.0f), // down
+        glm::vec2(-1.0f, 0.0f)  // left
+    };
+    float max = 0.0f;
+    int best = -1;
+    for(int i = 0; i < 4; i++) {
+        float dot = glm::dot(glm::normalize(target), compass[i]);
+        if(dot > max) {
+            max = dot;
+            best = i;
+        }
+    }
+    return best;
+}
+
+// the old Game::CheckCollision(BallObject&, GameObject&)
+bool checkCollision(glm::vec2 position, glm::vec2 size, glm::vec2 center, float radius, int& direction) {
+    glm::vec2 half = size / 2.0f;
+    glm::vec2 boxCenter = position + half;
+    glm::vec2 closest = boxCenter + glm::clamp(center - boxCenter, -half, half);
+    glm::vec2 difference = closest - center;
+    if(glm::length(difference) > radius)
+        return false;
+    direction = vectorDirection(difference);
+    return true;
+}
+
+template<unsigned int Width>
+double collideCircle(const BoxBounds& bounds, unsigned int boxes, const std::vector<glm::vec2>& centers, unsigned int& hits) {
+    auto start = std::chrono::steady_clock::now();
+    hits = 0;
+    for(glm::vec2 center : centers)
+        for(unsigned int first = 0; first < boxes; first += Width) {
+            unsigned int mask = CollideCircle<Width>(bounds, first, center, BALL_RADIUS).Mask;
+            for(; mask; mask &= mask - 1)
+                hits++;
+        }
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char** argv) {
+    unsigned int boxes = argc > 1 ? std::atoi(argv[1]) : 1024;
+    unsigned int circles = argc > 2 ? std::atoi(argv[2]) : 20000;
+    // the SIMD widths read whole registers, the bounds are padded but the scalar arrays are not
+    boxes = SimdPadded(boxes);
+
+    // random bricks and ball positions over the upper half of the screen
+    std::mt19937 random(1);
+    std::uniform_real_distribution<float> x(0.0f, 800.0f), y(0.0f, 300.0f), width(20.0f, 60.0f), height(10.0f, 30.0f);
+    std::vector<glm::vec2> positions(boxes), sizes(boxes), centers(circles);
+    BoxBounds bounds;
+    bounds.Resize(boxes);
+    for(unsigned int i = 0; i < boxes; i++) {
+        positions[i] = glm::vec2(x(random), y(random));
+        sizes[i] = glm::vec2(width(random), height(random));
+        bounds.Set(i, positions[i], sizes[i]);
+        if(i % CLEARED_EVERY == 0)
+            bounds.Clear(i);
+    }
+    for(glm::vec2& center : centers)
+        center = glm::vec2(x(random), y(random));
+
+    auto start = std::chrono::steady_clock::now();
+    unsigned int hits = 0;
+    volatile int directions = 0;
+    for(glm::vec2 center : centers)
+        for(unsigned int i = 0; i < boxes; i++) {
+            int direction;
+            if(i % CLEARED_EVERY != 0 && checkCollision(positions[i], sizes[i], center, BALL_RADIUS, direction)) {
+                hits++;
+                directions += direction;
+            }
+        }
+    double scalar = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+    unsigned int hits1, hits4, hits8;
+    double width1 = collideCircle<1>(bounds, boxes, centers, hits1);
+    double width4 = collideCircle<4>(bounds, boxes, centers, hits4);
+    double width8 = collideCircle<8>(bounds, boxes, centers, hits8);
+
+    double tests = double(boxes) * circles;
+    std::printf("%u boxes, %u circles, SIMD_WIDTH %u\n", boxes, circles, SIMD_WIDTH);
+    std::printf("CheckCollision + VectorDirection %6.2f ns/box  hits %u\n", scalar / tests, hits);
+    std::printf("CollideCircle<1>                 %6.2f ns/box  hits %u\n", width1 / tests, hits1);
+    std::printf("CollideCircle<4>                 %6.2f ns/box  hits %u%s\n", width4 / tests, hits4,
+#if defined(SIMD_SSE2)
+        "");
+#else
+        "  (scalar)");
+#endif
+    std::printf("CollideCircle<8>                 %6.2f ns/box  hits %u%s\n", width8 / tests, hits8,
+#if defined(SIMD_AVX)
+        "");
+#else
+        "  (scalar)");
+#endif
+    return hits1 == hits && hits4 == hits && hits8 == hits ? 0 : 1;
+}
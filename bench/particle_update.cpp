@@ -0,0 +1,62 @@
+// Throughput of the particle update: ParticleGenerator::Simulate over the SIMD aligned
+// arrays against the array of Particle structs the generator used before.
+// usage: bench_particle_update [particles] [updates] [--osmesa]
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "bench_context.h"
+#include "particle_generator.h"
+
+const float UPDATE_DT = 1.0f / 240.0f;
+
+// the particle of the old generator
+struct Particle {
+    glm::vec2 Position, Velocity;
+    glm::vec4 Color;
+    float Life;
+};
+
+int main(int argc, char** argv) {
+    // the generator creates its buffers on construction, so it needs a context
+    GLFWwindow* window = CreateBenchContext(argc, argv);
+    if(!window)
+        return -1;
+    unsigned int particles = argc > 1 && argv[1][0] != '-' ? std::atoi(argv[1]) : 100000;
+    unsigned int updates = argc > 2 && argv[2][0] != '-' ? std::atoi(argv[2]) : 1000;
+    // long enough that every particle stays alive through all updates
+    float life = 2.0f * updates * UPDATE_DT;
+
+    std::vector<Particle> old(particles);
+    for(unsigned int i = 0; i < particles; i++)
+        old[i] = { glm::vec2(i % 800, i % 600), glm::vec2(i % 7, -30.0f), glm::vec4(1.0f), life };
+    auto start = std::chrono::steady_clock::now();
+    for(unsigned int u = 0; u < updates; u++)
+        for(Particle& p : old) {
+            p.Life -= UPDATE_DT;
+            if(p.Life > 0.0f) {
+                p.Position -= p.Velocity * UPDATE_DT;
+                p.Color.a -= UPDATE_DT * 2.5f;
+            }
+        }
+    double aos = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    ParticleGenerator generator(Shader(), 0, particles);
+    for(unsigned int i = 0; i < particles; i++)
+        generator.Spawn({ glm::vec2(i % 800, i % 600), glm::vec2(i % 7, -30.0f), glm::vec4(1.0f), life, 2.5f, PARTICLE_PRIORITY_NORMAL });
+    start = std::chrono::steady_clock::now();
+    for(unsigned int u = 0; u < updates; u++)
+        generator.Simulate(UPDATE_DT, 0, generator.LiveCount());
+    double soa = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    double total = double(particles) * updates;
+    std::printf("%u particles, %u updates, SIMD_WIDTH %u\n", particles, updates, SIMD_WIDTH);
+    std::printf("array of Particle      %8.0f particles/ms\n", total / aos);
+    std::printf("Simulate (SoA, SIMD)   %8.0f particles/ms  live %u\n", total / soa, generator.LiveCount());
+
+    glfwTerminate();
+    return 0;
+}
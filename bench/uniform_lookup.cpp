@@ -0,0 +1,78 @@
+// Cost of setting two per sprite uniforms, by how the location is found: glGetUniformLocation
+// on every call as the renderers did before the uniform table, a string hashed at runtime, a
+// UniformName hashed at compile time, and a location resolved once.
+// usage: bench_uniform_lookup [sprites] [--osmesa]
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+#include <glm/glm.hpp>
+
+#include "bench_context.h"
+#include "shader.h"
+
+// projection is declared by the FrameData block Shader::Compile inserts
+const char* VERTEX_SOURCE =
+    "#version 330 core\n"
+    "layout (location = 0) in vec2 vertex;\n"
+    "uniform vec2 offset;\n"
+    "void main() {\n"
+    "    gl_Position = projection * vec4(vertex + offset, 0.0, 1.0);\n"
+    "}\n";
+const char* FRAGMENT_SOURCE =
+    "#version 330 core\n"
+    "out vec4 fragment;\n"
+    "uniform vec4 color;\n"
+    "void main() {\n"
+    "    fragment = color;\n"
+    "}\n";
+
+constexpr UniformName UNIFORM_OFFSET("offset");
+constexpr UniformName UNIFORM_COLOR("color");
+
+template<typename Set>
+double nanosecondsPerSprite(unsigned int sprites, Set set) {
+    auto start = std::chrono::steady_clock::now();
+    for(unsigned int i = 0; i < sprites; i++)
+        set(glm::vec2(i % 800, i % 600), glm::vec4(1.0f, 0.5f, 0.25f, 1.0f));
+    glFinish();
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / sprites;
+}
+
+int main(int argc, char** argv) {
+    GLFWwindow* window = CreateBenchContext(argc, argv);
+    if(!window)
+        return -1;
+    unsigned int sprites = argc > 1 && argv[1][0] != '-' ? std::atoi(argv[1]) : 200000;
+
+    Shader shader;
+    shader.Compile(VERTEX_SOURCE, FRAGMENT_SOURCE);
+    shader.Use();
+
+    double driver = nanosecondsPerSprite(sprites, [&](glm::vec2 offset, const glm::vec4& color) {
+        glUniform2f(glGetUniformLocation(shader.ID, "offset"), offset.x, offset.y);
+        glUniform4f(glGetUniformLocation(shader.ID, "color"), color.r, color.g, color.b, color.a);
+    });
+    double string = nanosecondsPerSprite(sprites, [&](glm::vec2 offset, const glm::vec4& color) {
+        shader.SetVector2f("offset", offset);
+        shader.SetVector4f("color", color);
+    });
+    double hashed = nanosecondsPerSprite(sprites, [&](glm::vec2 offset, const glm::vec4& color) {
+        shader.SetVector2f(UNIFORM_OFFSET, offset);
+        shader.SetVector4f(UNIFORM_COLOR, color);
+    });
+    int offsetLocation = shader.GetUniform(UNIFORM_OFFSET), colorLocation = shader.GetUniform(UNIFORM_COLOR);
+    double resolved = nanosecondsPerSprite(sprites, [&](glm::vec2 offset, const glm::vec4& color) {
+        shader.SetVector2f(offsetLocation, offset);
+        shader.SetVector4f(colorLocation, color);
+    });
+
+    std::printf("%u sprites, 2 uniforms each\n", sprites);
+    std::printf("glGetUniformLocation  %6.1f ns/sprite\n", driver);
+    std::printf("string (hashed)       %6.1f ns/sprite\n", string);
+    std::printf("UniformName           %6.1f ns/sprite\n", hashed);
+    std::printf("resolved location     %6.1f ns/sprite\n", resolved);
+
+    glfwTerminate();
+    return 0;
+}
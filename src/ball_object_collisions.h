@@ -19,9 +19,7 @@ public:
     bool Sticky, PassThrough;
 
     BallObject();
-    BallObject(glm::vec2 pos, float radius, glm::vec2 velocity, Texture2D sprite);
-
-    glm::vec2 Move(float dt, unsigned int window_width);
+    BallObject(glm::vec2 pos, float radius, glm::vec2 velocity, TextureHandle sprite);
 
     void Reset(glm::vec2 position, glm::vec2 velocity);
 };
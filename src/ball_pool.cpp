@@ -0,0 +1,123 @@
+#include "ball_pool.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "resource_manager.h"
+
+BallPool::BallPool(TextureHandle sprite, float radius)
+    : Radius(radius), Color(1.0f), sprite(sprite) {}
+
+unsigned int BallPool::Size() const {
+    return this->PositionX.size();
+}
+
+void BallPool::Add(glm::vec2 position, glm::vec2 velocity) {
+    this->PositionX.push_back(position.x);
+    this->PositionY.push_back(position.y);
+    this->VelocityX.push_back(velocity.x);
+    this->VelocityY.push_back(velocity.y);
+}
+
+void BallPool::Remove(unsigned int index) {
+    this->PositionX[index] = this->PositionX.back();
+    this->PositionY[index] = this->PositionY.back();
+    this->VelocityX[index] = this->VelocityX.back();
+    this->VelocityY[index] = this->VelocityY.back();
+    this->PositionX.pop_back();
+    this->PositionY.pop_back();
+    this->VelocityX.pop_back();
+    this->VelocityY.pop_back();
+}
+
+void BallPool::Clear() {
+    this->PositionX.clear();
+    this->PositionY.clear();
+    this->VelocityX.clear();
+    this->VelocityY.clear();
+}
+
+void BallPool::Near(glm::vec2 min, glm::vec2 max, float dt, std::vector<unsigned char>& out) const {
+    unsigned int count = this->Size();
+    out.resize(count);
+    // the box is grown by the ball size, so only the top left corners have to be tested
+    float diameter = this->Radius * 2.0f;
+    float minX = min.x - diameter, minY = min.y - diameter;
+    const float* px = this->PositionX.data(), * py = this->PositionY.data();
+    const float* vx = this->VelocityX.data(), * vy = this->VelocityY.data();
+    unsigned char* near = out.data();
+    // branch free, so the compiler can vectorize it
+    for(unsigned int i = 0; i < count; i++) {
+        float endX = px[i] + vx[i] * dt, endY = py[i] + vy[i] * dt;
+        near[i] = (std::max(px[i], endX) >= minX) & (std::min(px[i], endX) <= max.x)
+                & (std::max(py[i], endY) >= minY) & (std::min(py[i], endY) <= max.y);
+    }
+}
+
+unsigned int BallPool::Collide() {
+    unsigned int count = this->Size();
+    if(this->order.size() != count) {
+        this->order.resize(count);
+        for(unsigned int i = 0; i < count; i++)
+            this->order[i] = i;
+    }
+
+    // insertion sort by the left edge, balls move little per frame so this is close to linear
+    float* px = this->PositionX.data(), * py = this->PositionY.data();
+    float* vx = this->VelocityX.data(), * vy = this->VelocityY.data();
+    for(unsigned int i = 1; i < count; i++) {
+        unsigned int ball = this->order[i];
+        unsigned int j = i;
+        for(; j > 0 && px[this->order[j - 1]] > px[ball]; j--)
+            this->order[j] = this->order[j - 1];
+        this->order[j] = ball;
+    }
+
+    // sweep: a ball can only touch the balls that start less than a diameter to its right
+    float diameter = this->Radius * 2.0f;
+    unsigned int contacts = 0;
+    for(unsigned int i = 0; i < count; i++) {
+        unsigned int a = this->order[i];
+        for(unsigned int j = i + 1; j < count && px[this->order[j]] - px[a] < diameter; j++) {
+            unsigned int b = this->order[j];
+            float dx = px[b] - px[a], dy = py[b] - py[a];
+            float distance2 = dx * dx + dy * dy;
+            if(std::abs(dy) >= diameter || distance2 >= diameter * diameter || distance2 == 0.0f)
+                continue;
+            contacts++;
+
+            // equal masses: the velocities along the normal are exchanged if the balls approach
+            float distance = std::sqrt(distance2);
+            float nx = dx / distance, ny = dy / distance;
+            float approach = (vx[a] - vx[b]) * nx + (vy[a] - vy[b]) * ny;
+            if(approach > 0.0f) {
+                vx[a] -= approach * nx;
+                vy[a] -= approach * ny;
+                vx[b] += approach * nx;
+                vy[b] += approach * ny;
+            }
+            // push both balls apart by half the overlap
+            float push = (diameter - distance) * 0.5f;
+            px[a] -= nx * push;
+            py[a] -= ny * push;
+            px[b] += nx * push;
+            py[b] += ny * push;
+        }
+    }
+    return contacts;
+}
+
+void BallPool::Submit(RenderQueue& queue, SpriteRenderer& renderer) {
+    if(this->PositionX.empty())
+        return;
+    // same key as a sprite command, so the balls end up in the batch of the player's ball
+    TextureRegion& texture = ResourceManager::GetTexture(this->sprite);
+    uint64_t key = RenderQueue::MakeKey(LAYER_BALL, BLEND_ALPHA, renderer.GetShader().ID, texture.Texture.ID);
+    queue.Submit(key, this, [this, &renderer, &texture]() {
+        glm::vec2 size(this->Radius * 2.0f);
+        for(unsigned int i = 0; i < this->Size(); i++)
+            renderer.DrawSprite(texture, glm::vec2(this->PositionX[i], this->PositionY[i]), size, 0.0f, this->Color);
+        // the batch is flushed by the render queue
+        return 0u;
+    });
+}
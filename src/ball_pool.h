@@ -0,0 +1,41 @@
+#ifndef BALL_POOL_H
+#define BALL_POOL_H
+
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "simd.h"
+#include "texture.h"
+#include "render_queue.h"
+#include "sprite_renderer.h"
+
+// BallPool keeps the balls besides the player's ball (multi-ball power ups and
+// the stress mode) in contiguous arrays, one per coordinate. All balls of the
+// pool share their radius and color. Removing a ball moves the last ball into
+// its slot, so the arrays never have holes.
+class BallPool {
+public:
+    // top left corner of every ball (like BallObject::Position) and its velocity
+    AlignedVector<float> PositionX, PositionY, VelocityX, VelocityY;
+    float Radius;
+    glm::vec3 Color;
+
+    BallPool(TextureHandle sprite, float radius);
+    unsigned int Size() const;
+    void Add(glm::vec2 position, glm::vec2 velocity);
+    void Remove(unsigned int index);
+    void Clear();
+    // flags the balls that can touch the box [min, max] while moving for dt, in a single pass over all balls
+    void Near(glm::vec2 min, glm::vec2 max, float dt, std::vector<unsigned char>& out) const;
+    // separates overlapping balls and exchanges their velocities along the contact normal, returns the number of contacts
+    unsigned int Collide();
+    // queue all balls as a single command
+    void Submit(RenderQueue& queue, SpriteRenderer& renderer);
+private:
+    TextureHandle sprite;
+    // ball indices sorted by the left edge, kept between frames as the order hardly changes
+    std::vector<unsigned int> order;
+};
+
+#endif
@@ -0,0 +1,48 @@
+#include "bit_set.h"
+
+BitSet::BitSet() : size(0) {}
+
+void BitSet::Assign(unsigned int count, bool value) {
+    this->size = count;
+    this->words.assign((count + 63) / 64, value ? ~uint64_t(0) : 0);
+    // bits past the end stay clear, so whole words can be counted and scanned
+    if(value && count % 64)
+        this->words.back() = (uint64_t(1) << (count % 64)) - 1;
+}
+
+unsigned int BitSet::Size() const {
+    return this->size;
+}
+
+bool BitSet::Test(unsigned int index) const {
+    return (this->words[index / 64] >> (index % 64)) & 1;
+}
+
+void BitSet::Set(unsigned int index) {
+    this->words[index / 64] |= uint64_t(1) << (index % 64);
+}
+
+void BitSet::Reset(unsigned int index) {
+    this->words[index / 64] &= ~(uint64_t(1) << (index % 64));
+}
+
+unsigned int BitSet::Count() const {
+    unsigned int count = 0;
+    for(uint64_t word : this->words)
+        count += CountBits(word);
+    return count;
+}
+
+unsigned int BitSet::First() const {
+    for(unsigned int w = 0; w < this->words.size(); w++)
+        if(this->words[w])
+            return w * 64 + LowestBit(this->words[w]);
+    return this->size;
+}
+
+unsigned int BitSet::Last() const {
+    for(unsigned int w = this->words.size(); w-- > 0;)
+        if(this->words[w])
+            return w * 64 + HighestBit(this->words[w]);
+    return this->size;
+}
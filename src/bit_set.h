@@ -0,0 +1,71 @@
+#ifndef BIT_SET_H
+#define BIT_SET_H
+
+#include <cstdint>
+#include <vector>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+// number of set bits of a word
+inline unsigned int CountBits(uint64_t word) {
+#if defined(_MSC_VER)
+    return static_cast<unsigned int>(__popcnt64(word));
+#else
+    return __builtin_popcountll(word);
+#endif
+}
+
+// index of the lowest / highest set bit of a word, the word must not be 0
+inline unsigned int LowestBit(uint64_t word) {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward64(&index, word);
+    return index;
+#else
+    return __builtin_ctzll(word);
+#endif
+}
+
+inline unsigned int HighestBit(uint64_t word) {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanReverse64(&index, word);
+    return index;
+#else
+    return 63 - __builtin_clzll(word);
+#endif
+}
+
+// BitSet packs one bit per index into 64 bit words. Walking the set bits skips
+// empty words as a whole and finds the bits of a word with count trailing
+// zeros, so the cost follows the number of set bits rather than the size.
+class BitSet {
+public:
+    BitSet();
+    // resizes to count bits, all of them set to value
+    void Assign(unsigned int count, bool value);
+    unsigned int Size() const;
+    bool Test(unsigned int index) const;
+    void Set(unsigned int index);
+    void Reset(unsigned int index);
+    // number of set bits, counted word by word
+    unsigned int Count() const;
+    // index of the first / last set bit, Size() if no bit is set
+    unsigned int First() const;
+    unsigned int Last() const;
+
+    // calls function(index) for every set bit in ascending order
+    template<typename Function>
+    void ForEach(Function function) const {
+        for(unsigned int w = 0; w < this->words.size(); w++)
+            for(uint64_t word = this->words[w]; word; word &= word - 1)
+                function(w * 64 + LowestBit(word));
+    }
+private:
+    std::vector<uint64_t> words;
+    unsigned int size;
+};
+
+#endif
@@ -0,0 +1,81 @@
+#include "box_collision.h"
+
+#include <cfloat>
+
+// half extent of an empty box, the closest point of such a box is always out of reach
+const float EMPTY_HALF_EXTENT = -FLT_MAX;
+
+void BoxBounds::Resize(unsigned int count) {
+    unsigned int padded = SimdPadded(count);
+    this->CenterX.assign(padded, 0.0f);
+    this->CenterY.assign(padded, 0.0f);
+    this->HalfX.assign(padded, EMPTY_HALF_EXTENT);
+    this->HalfY.assign(padded, EMPTY_HALF_EXTENT);
+}
+
+void BoxBounds::Set(unsigned int index, glm::vec2 position, glm::vec2 size) {
+    this->CenterX[index] = position.x + size.x / 2.0f;
+    this->CenterY[index] = position.y + size.y / 2.0f;
+    this->HalfX[index] = size.x / 2.0f;
+    this->HalfY[index] = size.y / 2.0f;
+}
+
+void BoxBounds::Clear(unsigned int index) {
+    this->HalfX[index] = EMPTY_HALF_EXTENT;
+    this->HalfY[index] = EMPTY_HALF_EXTENT;
+}
+
+#if defined(SIMD_SSE2)
+template<>
+CircleContacts<4> CollideCircle<4>(const BoxBounds& bounds, unsigned int first, glm::vec2 center, float radius) {
+    const __m128 zero = _mm_setzero_ps(), one = _mm_set1_ps(1.0f), sign = _mm_set1_ps(-0.0f);
+    __m128 ox = _mm_sub_ps(_mm_set1_ps(center.x), _mm_load_ps(&bounds.CenterX[first]));
+    __m128 oy = _mm_sub_ps(_mm_set1_ps(center.y), _mm_load_ps(&bounds.CenterY[first]));
+    __m128 hx = _mm_load_ps(&bounds.HalfX[first]), hy = _mm_load_ps(&bounds.HalfY[first]);
+    __m128 nx = _mm_sub_ps(ox, _mm_min_ps(_mm_max_ps(ox, _mm_sub_ps(zero, hx)), hx));
+    __m128 ny = _mm_sub_ps(oy, _mm_min_ps(_mm_max_ps(oy, _mm_sub_ps(zero, hy)), hy));
+    __m128 distance = _mm_add_ps(_mm_mul_ps(nx, nx), _mm_mul_ps(ny, ny));
+
+    CircleContacts<4> contacts;
+    contacts.Mask = _mm_movemask_ps(_mm_cmple_ps(distance, _mm_set1_ps(radius * radius)));
+    __m128 inside = _mm_and_ps(_mm_cmpeq_ps(nx, zero), _mm_cmpeq_ps(ny, zero));
+    if(_mm_movemask_ps(inside)) {
+        // the face with the least penetration, the normal takes the sign of the offset
+        __m128 faceX = _mm_cmplt_ps(_mm_sub_ps(hx, _mm_andnot_ps(sign, ox)), _mm_sub_ps(hy, _mm_andnot_ps(sign, oy)));
+        __m128 insideX = _mm_and_ps(_mm_and_ps(inside, faceX), _mm_or_ps(_mm_and_ps(ox, sign), one));
+        __m128 insideY = _mm_and_ps(_mm_andnot_ps(faceX, inside), _mm_or_ps(_mm_and_ps(oy, sign), one));
+        nx = _mm_or_ps(_mm_andnot_ps(inside, nx), insideX);
+        ny = _mm_or_ps(_mm_andnot_ps(inside, ny), insideY);
+    }
+    _mm_store_ps(contacts.NormalX, nx);
+    _mm_store_ps(contacts.NormalY, ny);
+    return contacts;
+}
+#endif
+
+#if defined(SIMD_AVX)
+template<>
+CircleContacts<8> CollideCircle<8>(const BoxBounds& bounds, unsigned int first, glm::vec2 center, float radius) {
+    const __m256 zero = _mm256_setzero_ps(), one = _mm256_set1_ps(1.0f), sign = _mm256_set1_ps(-0.0f);
+    __m256 ox = _mm256_sub_ps(_mm256_set1_ps(center.x), _mm256_load_ps(&bounds.CenterX[first]));
+    __m256 oy = _mm256_sub_ps(_mm256_set1_ps(center.y), _mm256_load_ps(&bounds.CenterY[first]));
+    __m256 hx = _mm256_load_ps(&bounds.HalfX[first]), hy = _mm256_load_ps(&bounds.HalfY[first]);
+    __m256 nx = _mm256_sub_ps(ox, _mm256_min_ps(_mm256_max_ps(ox, _mm256_sub_ps(zero, hx)), hx));
+    __m256 ny = _mm256_sub_ps(oy, _mm256_min_ps(_mm256_max_ps(oy, _mm256_sub_ps(zero, hy)), hy));
+    __m256 distance = _mm256_add_ps(_mm256_mul_ps(nx, nx), _mm256_mul_ps(ny, ny));
+
+    CircleContacts<8> contacts;
+    contacts.Mask = _mm256_movemask_ps(_mm256_cmp_ps(distance, _mm256_set1_ps(radius * radius), _CMP_LE_OQ));
+    __m256 inside = _mm256_and_ps(_mm256_cmp_ps(nx, zero, _CMP_EQ_OQ), _mm256_cmp_ps(ny, zero, _CMP_EQ_OQ));
+    if(_mm256_movemask_ps(inside)) {
+        // the face with the least penetration, the normal takes the sign of the offset
+        __m256 faceX = _mm256_cmp_ps(_mm256_sub_ps(hx, _mm256_andnot_ps(sign, ox)), _mm256_sub_ps(hy, _mm256_andnot_ps(sign, oy)), _CMP_LT_OQ);
+        __m256 signX = _mm256_or_ps(_mm256_and_ps(ox, sign), one), signY = _mm256_or_ps(_mm256_and_ps(oy, sign), one);
+        nx = _mm256_blendv_ps(nx, _mm256_and_ps(faceX, signX), inside);
+        ny = _mm256_blendv_ps(ny, _mm256_andnot_ps(faceX, signY), inside);
+    }
+    _mm256_store_ps(contacts.NormalX, nx);
+    _mm256_store_ps(contacts.NormalY, ny);
+    return contacts;
+}
+#endif
@@ -0,0 +1,72 @@
+#ifndef BOX_COLLISION_H
+#define BOX_COLLISION_H
+
+#include <algorithm>
+#include <cmath>
+
+#include <glm/glm.hpp>
+
+#include "simd.h"
+
+// BoxBounds keeps axis aligned boxes as a structure of arrays, so a SIMD
+// register holds one coordinate of SIMD_WIDTH boxes. The arrays are aligned
+// and padded to a multiple of SIMD_PADDING. Padding and cleared boxes are
+// empty, no circle ever touches them.
+struct BoxBounds {
+    AlignedVector<float> CenterX, CenterY, HalfX, HalfY;
+
+    // resizes to count empty boxes (plus the padding)
+    void Resize(unsigned int count);
+    void Set(unsigned int index, glm::vec2 position, glm::vec2 size);
+    // makes a box empty
+    void Clear(unsigned int index);
+};
+
+// result of testing a circle against Width consecutive boxes
+template<unsigned int Width>
+struct CircleContacts {
+    unsigned int Mask; // bit i is set if the circle touches box first + i
+    // contact normals, from the closest point of the box to the circle center (not normalized).
+    // a circle centered inside a box gets the unit normal of the face it is closest to
+    alignas(SIMD_ALIGNMENT) float NormalX[Width];
+    alignas(SIMD_ALIGNMENT) float NormalY[Width];
+};
+
+// tests a circle against the boxes first .. first + Width - 1, first must be a multiple of Width.
+// distances are compared squared and the face is found from the offsets, nothing is normalized.
+// this is the scalar version, widths 4 and 8 have SSE2 and AVX versions when they are enabled
+template<unsigned int Width>
+CircleContacts<Width> CollideCircle(const BoxBounds& bounds, unsigned int first, glm::vec2 center, float radius) {
+    CircleContacts<Width> contacts;
+    contacts.Mask = 0;
+    for(unsigned int i = 0; i < Width; i++) {
+        float ox = center.x - bounds.CenterX[first + i], oy = center.y - bounds.CenterY[first + i];
+        float hx = bounds.HalfX[first + i], hy = bounds.HalfY[first + i];
+        // offset of the center from the closest point of the box
+        float nx = ox - std::min(std::max(ox, -hx), hx);
+        float ny = oy - std::min(std::max(oy, -hy), hy);
+        if(nx * nx + ny * ny <= radius * radius)
+            contacts.Mask |= 1u << i;
+        if(nx == 0.0f && ny == 0.0f) {
+            // inside, the face with the least penetration
+            if(hx - std::abs(ox) < hy - std::abs(oy))
+                nx = std::copysign(1.0f, ox);
+            else
+                ny = std::copysign(1.0f, oy);
+        }
+        contacts.NormalX[i] = nx;
+        contacts.NormalY[i] = ny;
+    }
+    return contacts;
+}
+
+#if defined(SIMD_SSE2)
+template<>
+CircleContacts<4> CollideCircle<4>(const BoxBounds& bounds, unsigned int first, glm::vec2 center, float radius);
+#endif
+#if defined(SIMD_AVX)
+template<>
+CircleContacts<8> CollideCircle<8>(const BoxBounds& bounds, unsigned int first, glm::vec2 center, float radius);
+#endif
+
+#endif
@@ -0,0 +1,125 @@
+#include "brick_bvh.h"
+
+#include <algorithm>
+#include <cfloat>
+
+// a parent that is not a node, the root's parent
+const unsigned int NO_PARENT = ~0u;
+// depth of the traversal stack, median splits keep the tree balanced so this is never reached
+const unsigned int BVH_STACK_SIZE = 64;
+
+void BrickBVH::Build(const BrickStore& bricks, std::vector<unsigned int>& order) {
+    this->Clear();
+    order.resize(bricks.Size());
+    for(unsigned int i = 0; i < bricks.Size(); i++)
+        order[i] = i;
+    if(!bricks.Size())
+        return;
+    this->nodes.reserve(2 * bricks.Size() / BVH_LEAF_SIZE + 1);
+    this->brickLeaves.resize(bricks.Size());
+    this->build(bricks, order, 0, bricks.Size(), NO_PARENT);
+}
+
+void BrickBVH::Clear() {
+    this->nodes.clear();
+    this->parents.clear();
+    this->brickLeaves.clear();
+}
+
+void BrickBVH::Refit(const BrickStore& bricks, unsigned int brick) {
+    unsigned int node = this->brickLeaves[brick];
+    this->fitLeaf(bricks, this->nodes[node]);
+    // the parents only get smaller, so the walk stops as soon as a node's bounds stay the same
+    for(node = this->parents[node]; node != NO_PARENT; node = this->parents[node]) {
+        BVHNode& parent = this->nodes[node];
+        const BVHNode& first = this->nodes[node + 1], & second = this->nodes[parent.Next];
+        glm::vec2 min = glm::min(first.Min, second.Min), max = glm::max(first.Max, second.Max);
+        if(min == parent.Min && max == parent.Max)
+            break;
+        parent.Min = min;
+        parent.Max = max;
+    }
+}
+
+void BrickBVH::Query(glm::vec2 min, glm::vec2 max, std::vector<unsigned int>& out) const {
+    out.clear();
+    if(this->nodes.empty())
+        return;
+
+    // depth first, first child before the second, so the leaves and their bricks come in ascending order
+    unsigned int stack[BVH_STACK_SIZE];
+    unsigned int size = 0;
+    stack[size++] = 0;
+    while(size) {
+        unsigned int index = stack[--size];
+        const BVHNode& node = this->nodes[index];
+        // empty bounds (min > max) never overlap
+        if(node.Max.x < min.x || node.Min.x > max.x || node.Max.y < min.y || node.Min.y > max.y)
+            continue;
+        if(node.Count == 0) {
+            stack[size++] = node.Next;
+            stack[size++] = index + 1;
+            continue;
+        }
+        for(unsigned int i = node.Next; i < node.Next + node.Count; i++)
+            out.push_back(i);
+    }
+}
+
+unsigned int BrickBVH::build(const BrickStore& bricks, std::vector<unsigned int>& order, unsigned int first,
+    unsigned int count, unsigned int parent) {
+    unsigned int index = this->nodes.size();
+    this->nodes.push_back(BVHNode());
+    this->parents.push_back(parent);
+
+    if(count <= BVH_LEAF_SIZE) {
+        BVHNode& leaf = this->nodes[index];
+        leaf.Next = first;
+        leaf.Count = count;
+        leaf.Min = glm::vec2(FLT_MAX);
+        leaf.Max = glm::vec2(-FLT_MAX);
+        for(unsigned int i = first; i < first + count; i++) {
+            const BrickInstance& brick = bricks.Instances[order[i]];
+            this->brickLeaves[i] = index;
+            leaf.Min = glm::min(leaf.Min, brick.Position);
+            leaf.Max = glm::max(leaf.Max, brick.Position + brick.Size);
+        }
+        return index;
+    }
+
+    // split at the median center along the longer axis of the centers
+    glm::vec2 min(FLT_MAX), max(-FLT_MAX);
+    for(unsigned int i = first; i < first + count; i++) {
+        const BrickInstance& brick = bricks.Instances[order[i]];
+        glm::vec2 center = brick.Position + brick.Size / 2.0f;
+        min = glm::min(min, center);
+        max = glm::max(max, center);
+    }
+    int axis = max.x - min.x >= max.y - min.y ? 0 : 1;
+    unsigned int half = count / 2;
+    std::nth_element(order.begin() + first, order.begin() + first + half, order.begin() + first + count,
+        [&bricks, axis](unsigned int a, unsigned int b) {
+            const BrickInstance& one = bricks.Instances[a], & two = bricks.Instances[b];
+            return one.Position[axis] + one.Size[axis] / 2.0f < two.Position[axis] + two.Size[axis] / 2.0f;
+        });
+
+    this->build(bricks, order, first, half, index);
+    unsigned int second = this->build(bricks, order, first + half, count - half, index);
+    // the vector may have grown, so the node is looked up again
+    BVHNode& node = this->nodes[index];
+    node.Next = second;
+    node.Count = 0;
+    node.Min = glm::min(this->nodes[index + 1].Min, this->nodes[second].Min);
+    node.Max = glm::max(this->nodes[index + 1].Max, this->nodes[second].Max);
+    return index;
+}
+
+void BrickBVH::fitLeaf(const BrickStore& bricks, BVHNode& leaf) const {
+    leaf.Min = glm::vec2(FLT_MAX);
+    leaf.Max = glm::vec2(-FLT_MAX);
+    for(unsigned int i = leaf.Next; i < leaf.Next + leaf.Count; i++)
+        if(bricks.Live.Test(i)) {
+            leaf.Min = glm::min(leaf.Min, bricks.Instances[i].Position);
+            leaf.Max = glm::max(leaf.Max, bricks.Instances[i].Position + bricks.Instances[i].Size);
+        }
+}
@@ -0,0 +1,50 @@
+#ifndef BRICK_BVH_H
+#define BRICK_BVH_H
+
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "brick_store.h"
+
+// bricks a leaf of the tree holds at most
+const unsigned int BVH_LEAF_SIZE = 4;
+
+// node of the flattened tree. the nodes are stored depth first, so the first
+// child of an internal node directly follows it
+struct BVHNode {
+    glm::vec2 Min, Max;  // bounds of the live bricks below the node, empty if there are none
+    unsigned int Next;   // internal node: index of the second child, leaf: first brick
+    unsigned int Count;  // bricks of a leaf, 0 for internal nodes
+};
+
+// BrickBVH is a static bounding volume hierarchy over bricks of any position
+// and size. It is built once with median splits and stored as an array, so a
+// query walks memory mostly forward. Destroying a brick only refits the
+// bounds on the path from its leaf to the root.
+class BrickBVH {
+public:
+    // builds the tree over the bricks. order receives the brick order of the tree, brick i of the tree is
+    // bricks[order[i]]. the bricks have to be reordered by it, then every leaf holds a consecutive range
+    void Build(const BrickStore& bricks, std::vector<unsigned int>& order);
+    // removes everything, queries find nothing afterwards
+    void Clear();
+    // recomputes the bounds of the leaf of brick and of the nodes above it from the bricks that are not destroyed
+    void Refit(const BrickStore& bricks, unsigned int brick);
+    // replaces the contents of out with the bricks (destroyed ones included) of the leaves overlapping
+    // the box [min, max], in ascending order
+    void Query(glm::vec2 min, glm::vec2 max, std::vector<unsigned int>& out) const;
+private:
+    std::vector<BVHNode> nodes;
+    // parent of every node and leaf of every brick, for refitting
+    std::vector<unsigned int> parents;
+    std::vector<unsigned int> brickLeaves;
+
+    // builds the subtree over the bricks order[first .. first + count), returns its node index
+    unsigned int build(const BrickStore& bricks, std::vector<unsigned int>& order, unsigned int first,
+        unsigned int count, unsigned int parent);
+    // bounds of a leaf from its live bricks
+    void fitLeaf(const BrickStore& bricks, BVHNode& leaf) const;
+};
+
+#endif
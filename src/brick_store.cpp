@@ -0,0 +1,45 @@
+#include "brick_store.h"
+
+unsigned int BrickStore::Size() const {
+    return this->Instances.size();
+}
+
+void BrickStore::Clear() {
+    this->Bounds.Resize(0);
+    this->Live.Assign(0, false);
+    this->Solid.Assign(0, false);
+    this->Instances.clear();
+}
+
+void BrickStore::Add(glm::vec2 position, glm::vec2 size, unsigned int palette, bool solid) {
+    this->Instances.push_back({ position, size, palette, BRICK_ALIVE | (solid ? BRICK_SOLID : 0) });
+}
+
+void BrickStore::Reorder(const std::vector<unsigned int>& order) {
+    std::vector<BrickInstance> instances;
+    instances.reserve(order.size());
+    for(unsigned int brick : order)
+        instances.push_back(this->Instances[brick]);
+    this->Instances.swap(instances);
+}
+
+void BrickStore::Build() {
+    unsigned int count = this->Size();
+    this->Bounds.Resize(count);
+    this->Live.Assign(count, false);
+    this->Solid.Assign(count, false);
+    for(unsigned int i = 0; i < count; i++) {
+        const BrickInstance& brick = this->Instances[i];
+        this->Bounds.Set(i, brick.Position, brick.Size);
+        if(brick.Flags & BRICK_ALIVE)
+            this->Live.Set(i);
+        if(brick.Flags & BRICK_SOLID)
+            this->Solid.Set(i);
+    }
+}
+
+void BrickStore::Destroy(unsigned int index) {
+    this->Bounds.Clear(index);
+    this->Live.Reset(index);
+    this->Instances[index].Flags &= ~BRICK_ALIVE;
+}
@@ -0,0 +1,47 @@
+#ifndef BRICK_STORE_H
+#define BRICK_STORE_H
+
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "box_collision.h"
+#include "bit_set.h"
+
+// brick instance flags
+const unsigned int BRICK_ALIVE = 1 << 0;
+const unsigned int BRICK_SOLID = 1 << 1;
+
+// per instance attributes of a brick as they are stored in the GPU instance buffer
+struct BrickInstance {
+    glm::vec2 Position;
+    glm::vec2 Size;
+    unsigned int Palette; // index into the level palette
+    unsigned int Flags;   // BRICK_ALIVE | BRICK_SOLID
+};
+
+// BrickStore holds the bricks of a level as components, one array per
+// component, all indexed by brick. The hot components are read by the
+// collision systems every step: the bounds in SIMD layout and the live and
+// solid flags as bitsets. The cold components are only read when a brick is
+// hit or drawn: its box and palette, stored as the GPU instances.
+struct BrickStore {
+    // hot, destroyed bricks have empty bounds and a clear live bit
+    BoxBounds Bounds;
+    BitSet Live, Solid;
+    // cold
+    std::vector<BrickInstance> Instances;
+
+    unsigned int Size() const;
+    void Clear();
+    // appends a brick to the cold components, Build has to be called once all bricks are added
+    void Add(glm::vec2 position, glm::vec2 size, unsigned int palette, bool solid);
+    // puts the bricks in a new order before Build, brick i becomes the brick order[i]
+    void Reorder(const std::vector<unsigned int>& order);
+    // fills the hot components from the cold ones
+    void Build();
+    // removes a brick from the hot components and flags its instance
+    void Destroy(unsigned int index);
+};
+
+#endif
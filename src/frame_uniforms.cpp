@@ -0,0 +1,28 @@
+#include "frame_uniforms.h"
+
+#include <cstddef>
+
+#include "shader.h"
+#include "gl_state.h"
+
+static_assert(offsetof(FrameUniformData, Time) == 64, "FrameUniformData must match the std140 layout");
+static_assert(sizeof(FrameUniformData) % 16 == 0, "FrameUniformData must match the std140 layout");
+
+FrameUniforms::FrameUniforms() : Data() {
+    this->Data.Projection = glm::mat4(1.0f);
+
+    glGenBuffers(1, &this->UBO);
+    GLState::BindBuffer(GL_UNIFORM_BUFFER, this->UBO);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(FrameUniformData), &this->Data, GL_DYNAMIC_DRAW);
+    // attach to the binding point all shaders read the block from
+    glBindBufferBase(GL_UNIFORM_BUFFER, FRAME_UNIFORM_BINDING, this->UBO);
+}
+
+FrameUniforms::~FrameUniforms() {
+    GLState::DeleteBuffer(this->UBO);
+}
+
+void FrameUniforms::Upload() {
+    GLState::BindBuffer(GL_UNIFORM_BUFFER, this->UBO);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(FrameUniformData), &this->Data);
+}
\ No newline at end of file
@@ -0,0 +1,35 @@
+#ifndef FRAME_UNIFORMS_H
+#define FRAME_UNIFORMS_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+// contents of the `FrameData` uniform block, laid out as std140
+// (declared once for all shaders by FRAME_UNIFORM_SOURCE in shader.h, the two have to match)
+struct FrameUniformData {
+    glm::mat4 Projection;   // offset 0
+    float Time;             // offset 64
+    int Confuse;            // offset 68, GLSL bool
+    int Chaos;              // offset 72, GLSL bool
+    int Shake;              // offset 76, GLSL bool
+    int Grayscale;          // offset 80, GLSL bool
+    float padding[3];       // block size is rounded up to a multiple of 16 bytes
+};
+static_assert(sizeof(FrameUniformData) == 96, "FrameUniformData has to match the std140 layout of FRAME_UNIFORM_SOURCE");
+
+// FrameUniforms owns the uniform buffer that backs the `FrameData` block of all
+// shaders. The data is changed on the CPU and written with a single buffer update
+// per frame instead of setting the same uniforms on every program.
+class FrameUniforms {
+public:
+    FrameUniformData Data;
+
+    FrameUniforms();
+    ~FrameUniforms();
+    // writes Data to the uniform buffer
+    void Upload();
+private:
+    unsigned int UBO;
+};
+
+#endif
\ No newline at end of file
@@ -1,6 +1,8 @@
 #include <iostream>
 #include <algorithm>
+#include <cmath>
 #include <sstream>
+#include <thread>
 
 #include <glm/glm.hpp>
 
@@ -11,31 +13,80 @@
 #include "resource_manager.h"
 #include "sprite_renderer.h"
 #include "ball_object_collisions.h"
-#include "particle_generator.h"
+#include "particle_system.h"
 #include "post_processor.h"
 #include "text_renderer.h"
+#include "render_queue.h"
+#include "gl_state.h"
+#include "frame_uniforms.h"
+#include "stream_buffer.h"
+#include "worker_pool.h"
+#include "ball_pool.h"
+#include "power_up_pool.h"
 
 // common render object to render our sprites
 SpriteRenderer* Renderer;
 GameObject* Player;
 BallObject* Ball;
-ParticleGenerator* Particles;
+ParticleSystem* Particles;
 PostProcessor* Effects;
 TextRenderer* Text;
+RenderQueue* Queue;
+FrameUniforms* Frame;
+WorkerPool* Workers;
+BallPool* Balls;
+PowerUpPool* FallingPowerUps;
+// bricks tested against the ball this frame
+std::vector<unsigned int> BrickCandidates;
+// falling power ups the paddle overlaps this frame
+std::vector<unsigned int> CaughtPowerUps;
+// pool balls that can reach the paddle this frame
+std::vector<unsigned char> BallsNearPaddle;
+// per thread state of moving the pool balls, the ball being moved and its brick candidates
+std::vector<BallObject> PoolBallScratch;
+std::vector<std::vector<unsigned int>> PoolBallCandidates;
 
 static ma_engine g_engine;
 static ma_result g_result;
 
 float ShakeTime = 0.0f;
 
+// level files relative to FS_SRC_PATH, in the order the level menu cycles through them
+const char* const LEVEL_FILES[] = { "levels/one.lvl", "levels/two.lvl", "levels/three.lvl", "levels/four.lvl", "levels/freeform.lvl" };
+
+// bytes of the stream buffer available to a single frame
+const unsigned int STREAM_REGION_SIZE = 4 << 20;
+// particle emitters, all of them share the PARTICLE_BUDGET
+unsigned int TrailEmitter, ShatterEmitter, FireworksEmitter, PickupEmitter;
+// settings: spawn rate, burst count, lifetime, fade, priority, color, color variance, spread, speed, inherited velocity
+const ParticleEmitterConfig TRAIL_EMITTER = { 120.0f, 0, 1.0f, 2.5f, PARTICLE_PRIORITY_NORMAL, glm::vec4(1.0f), 0.5f, 5.0f, 0.0f, -0.1f };
+const ParticleEmitterConfig SHATTER_EMITTER = { 0.0f, 40, 0.6f, 1.6f, PARTICLE_PRIORITY_NORMAL, glm::vec4(1.0f), 0.2f, 20.0f, 150.0f, 0.0f };
+const ParticleEmitterConfig FIREWORKS_EMITTER = { 0.0f, 200, 1.2f, 0.8f, PARTICLE_PRIORITY_LOW, glm::vec4(1.0f, 0.6f, 0.2f, 1.0f), 0.4f, 30.0f, 300.0f, 0.0f };
+const ParticleEmitterConfig PICKUP_EMITTER = { 0.0f, 60, 0.5f, 2.0f, PARTICLE_PRIORITY_HIGH, glm::vec4(1.0f), 0.1f, 10.0f, 120.0f, 0.0f };
+// pool balls moved per job, enough to be worth handing over to another thread
+const unsigned int BALL_JOB_SIZE = 256;
+// seed of the stress mode ball layout
+const uint32_t STRESS_SEED = 7;
+// impacts the ball resolves in a frame at most, the rest of its motion is dropped after that
+const unsigned int MAX_BALL_IMPACTS = 16;
+// simulation time that did not fill a whole step yet, double so whole steps subtract exactly
+double StepAccumulator = 0.0;
+// how far rendering is between the previous and the current simulation step
+float StepAlpha = 1.0f;
+// GL state cache counters of the previous frame
+GLStateCounters FrameGLCounters = { 0, 0 };
+
 const float explosionWait = 3;
-int explosionColor = 1;
+// the bricks about to explode switch between red and blue this often, independent of the step rate
+const float explosionFlash = 1.0f / 15.0f;
 float explosionTime = explosionWait;
 bool will_explode = false;
-std::vector<GameObject*> bricksToExplode = {};
+std::vector<unsigned int> bricksToExplode = {}; // indices into the current level's bricks
 
 Game::Game(unsigned int width, unsigned int height):
-    State{GAME_ACTIVE}, Keys{}, Width{width}, Height{height}, Level{0}, Lives{3} {}
+    State{GAME_ACTIVE}, Keys{}, Width{width}, Height{height}, Level{0}, Lives{3}, ShowStats{false}, FrameStats{}, Framebuffer{0},
+    WorkerThreads{std::max(std::thread::hardware_concurrency(), 1u) - 1}, Deterministic{false},
+    GpuParticles{false}, StressBalls{0}, BallCollisions{false} {}
 
 Game::~Game() {
     // clean audio resources
@@ -50,8 +101,14 @@ Game::~Game() {
     delete Renderer;
     delete Player;
     delete Ball;
+    delete Balls;
+    delete FallingPowerUps;
     delete Particles;
+    delete Workers;
     delete Text;
+    delete Queue;
+    delete Frame;
+    StreamBuffer::Clear();
 }
 
 void Game::init_audio() {
@@ -96,63 +153,95 @@ void Game::Init() {
     // load shaders
     ResourceManager::LoadShader("shaders/sprite.vs", "shaders/sprite.fs", nullptr, "sprite");
     ResourceManager::LoadShader("shaders/particle.vs", "shaders/particle.fs", nullptr, "particle");
+    ResourceManager::LoadShader("shaders/particle_update.vs", "shaders/particle_update.fs", nullptr, "particle_update",
+        { "outPosition", "outVelocity", "outColor", "outLife" });
     ResourceManager::LoadShader("shaders/post_processing.vs", "shaders/post_processing.fs", nullptr, "postprocessing");
+    ResourceManager::LoadShader("shaders/brick.vs", "shaders/brick.fs", nullptr, "brick");
     
-    // configure shaders
-    glm::mat4 projection = glm::ortho(0.0f, static_cast<float>(this->Width), static_cast<float>(this->Height), 0.0f, -1.0f, 1.0f);
+    // configure shaders, the projection is shared by all of them through the per frame uniform block
+    Frame = new FrameUniforms();
+    Frame->Data.Projection = glm::ortho(0.0f, static_cast<float>(this->Width), static_cast<float>(this->Height), 0.0f, -1.0f, 1.0f);
 
     ResourceManager::GetShader("sprite").Use().SetInteger("sprite", 0);
-    ResourceManager::GetShader("sprite").SetMatrix4("projection", projection);
     ResourceManager::GetShader("particle").Use().SetInteger("sprite", 0);
-    ResourceManager::GetShader("particle").SetMatrix4("projection", projection);
+    ResourceManager::GetShader("brick").Use().SetInteger("sprite", 0);
+    glUniform3fv(ResourceManager::GetShader("brick").GetUniform("palette"), PALETTE_SIZE, (float*)BRICK_PALETTE);
 
     // load textures
-    ResourceManager::LoadTexture("textures/awesomeface.png", true, "face");
     ResourceManager::LoadTexture("textures/background.jpg", false, "background");
-    ResourceManager::LoadTexture("textures/awesomeface.png", true, "face");
-    ResourceManager::LoadTexture("textures/block.png", false, "block");
-    ResourceManager::LoadTexture("textures/block_solid.png", false, "block_solid");
-    ResourceManager::LoadTexture("textures/paddle.png", true, "paddle");
-    
-    ResourceManager::LoadTexture("textures/particle.png", true, "particle");
-
-    ResourceManager::LoadTexture("textures/powerup_speed.png", true, "powerup_speed");
-    ResourceManager::LoadTexture("textures/powerup_sticky.png", true, "powerup_sticky");
-    ResourceManager::LoadTexture("textures/powerup_increase.png", true, "powerup_increase");
-    ResourceManager::LoadTexture("textures/powerup_confuse.png", true, "powerup_confuse");
-    ResourceManager::LoadTexture("textures/powerup_chaos.png", true, "powerup_chaos");
-    ResourceManager::LoadTexture("textures/powerup_passthrough.png", true, "powerup_passthrough");
-    ResourceManager::LoadTexture("textures/powerup_ball-decrease.png", true, "powerup_ball-decrease");
-    ResourceManager::LoadTexture("textures/powerup_ball-increase.png", true, "powerup_ball-increase");
-    ResourceManager::LoadTexture("textures/powerup_fireworks.png", true, "powerup_fireworks");
-
-    // set render specific controls
+
+    // all game object sprites are packed into a single atlas so they can be drawn without texture switches
+    ResourceManager::LoadTextureAtlas({
+        { "textures/awesomeface.png", "face" },
+        { "textures/block.png", "block" },
+        { "textures/block_solid.png", "block_solid" },
+        { "textures/paddle.png", "paddle" },
+        { "textures/particle.png", "particle" },
+        { "textures/powerup_speed.png", "powerup_speed" },
+        { "textures/powerup_sticky.png", "powerup_sticky" },
+        { "textures/powerup_increase.png", "powerup_increase" },
+        { "textures/powerup_confuse.png", "powerup_confuse" },
+        { "textures/powerup_chaos.png", "powerup_chaos" },
+        { "textures/powerup_passthrough.png", "powerup_passthrough" },
+        { "textures/powerup_ball-decrease.png", "powerup_ball-decrease" },
+        { "textures/powerup_ball-increase.png", "powerup_ball-increase" },
+        { "textures/powerup_fireworks.png", "powerup_fireworks" },
+        { "textures/powerup_multi-ball.png", "powerup_multi-ball" }
+    }, "sprites");
+
+    // set render specific controls, all transient vertex data is streamed through one ring buffer
+    StreamBuffer::Init(STREAM_REGION_SIZE);
     Renderer = new SpriteRenderer(ResourceManager::GetShader("sprite"));
-    Particles = new ParticleGenerator(ResourceManager::GetShader("particle"), ResourceManager::GetTexture("particle"), 500);
+    Queue = new RenderQueue(*Renderer);
+    Workers = new WorkerPool(this->WorkerThreads);
+    if(this->GpuParticles)
+        Particles = new ParticleSystem(ResourceManager::GetShader("particle"), ResourceManager::GetShader("particle_update"),
+            ResourceManager::GetTextureHandle("particle"), PARTICLE_BUDGET);
+    else
+        Particles = new ParticleSystem(ResourceManager::GetShader("particle"), ResourceManager::GetTextureHandle("particle"), PARTICLE_BUDGET);
+    Particles->Deterministic = this->Deterministic;
+    TrailEmitter = Particles->AddEmitter(TRAIL_EMITTER);
+    ShatterEmitter = Particles->AddEmitter(SHATTER_EMITTER);
+    FireworksEmitter = Particles->AddEmitter(FIREWORKS_EMITTER);
+    PickupEmitter = Particles->AddEmitter(PICKUP_EMITTER);
     Effects = new PostProcessor(ResourceManager::GetShader("postprocessing"), this->Width, this->Height);
-    Text = new TextRenderer(this->Width, this->Height);
+    Effects->Target = this->Framebuffer;
+    Text = new TextRenderer();
     Text->Load(std::string(FS_SRC_PATH) + "fonts/OCRAEXT.ttf", 24);
 
     // load levels
-    GameLevel one; one.Load((std::string(FS_SRC_PATH) + "levels/one.lvl").c_str(), this->Width, this->Height / 2);
-    GameLevel two; two.Load((std::string(FS_SRC_PATH) + "levels/two.lvl").c_str(), this->Width, this->Height / 2);
-    GameLevel three; three.Load((std::string(FS_SRC_PATH) + "levels/three.lvl").c_str(), this->Width, this->Height / 2);
-    GameLevel four; four.Load((std::string(FS_SRC_PATH) + "levels/four.lvl").c_str(), this->Width, this->Height / 2);
-
-    this->Levels.push_back(one);
-    this->Levels.push_back(two);
-    this->Levels.push_back(three);
-    this->Levels.push_back(four);
+    for(const char* file : LEVEL_FILES) {
+        GameLevel level; level.Load((std::string(FS_SRC_PATH) + file).c_str(), this->Width, this->Height / 2);
+        this->Levels.push_back(level);
+    }
 
     this->Level = 0;
 
     // paddle
     glm::vec2 playerPos = glm::vec2(this->Width / 2.0f - PLAYER_SIZE.x / 2.0f, this->Height - PLAYER_SIZE.y);
-    Player = new GameObject(playerPos, PLAYER_SIZE, ResourceManager::GetTexture("paddle"));
+    Player = new GameObject(playerPos, PLAYER_SIZE, ResourceManager::GetTextureHandle("paddle"));
 
     // ball
     glm::vec2 ballPos = playerPos + glm::vec2(PLAYER_SIZE.x / 2.0f - BALL_RADIUS, -BALL_RADIUS * 2.0f);
-    Ball = new BallObject(ballPos, BALL_RADIUS, INITIAL_BALL_VELOCITY, ResourceManager::GetTexture("face"));
+    Ball = new BallObject(ballPos, BALL_RADIUS, INITIAL_BALL_VELOCITY, ResourceManager::GetTextureHandle("face"));
+
+    // extra balls, the stress mode fills the lower half of the screen with small balls at the ball's speed
+    Balls = new BallPool(ResourceManager::GetTextureHandle("face"), BALL_RADIUS);
+    FallingPowerUps = new PowerUpPool();
+    if(this->StressBalls) {
+        Balls->Radius = STRESS_BALL_RADIUS;
+        Balls->Color = glm::vec3(0.6f, 0.8f, 1.0f);
+        SimdRandom random(STRESS_SEED);
+        float r[3];
+        for(unsigned int i = 0; i < this->StressBalls; i++) {
+            random.Uniform(r, 3);
+            glm::vec2 position(r[0] * (this->Width - STRESS_BALL_RADIUS * 2.0f), this->Height / 2.0f + r[1] * (this->Height / 2.0f - STRESS_BALL_RADIUS * 2.0f));
+            float angle = r[2] * 6.28318530718f;
+            Balls->Add(position, glm::vec2(std::cos(angle), std::sin(angle)) * glm::length(INITIAL_BALL_VELOCITY));
+        }
+    }
+    PoolBallScratch.resize(Workers->Threads() + 1);
+    PoolBallCandidates.resize(Workers->Threads() + 1);
 
     // audio
     ma_sound_start(&mySounds["breakout"]);
@@ -164,10 +253,17 @@ void Game::Init() {
 void Game::fireworks_explosion() {
     bool explosionEffect = false;
 
-    for(GameObject* brick : bricksToExplode) {
-        if(!brick->Destroyed && !explosionEffect) explosionEffect = true;
-        brick->Destroyed = true; // some bricks may already be destroyed by player
-                                 // but this should not have an effect
+    GameLevel& level = this->Levels[this->Level];
+
+    for(unsigned int brick : bricksToExplode) {
+        // some bricks may already be destroyed by player
+        // but this should not have an effect
+        if(level.Bricks().Live.Test(brick)) {
+            explosionEffect = true;
+            level.DestroyBrick(brick);
+            const BrickInstance& obj = level.Bricks().Instances[brick];
+            Particles->Burst(FireworksEmitter, obj.Position + obj.Size / 2.0f);
+        }
     }
 
     if(explosionEffect) {
@@ -178,15 +274,39 @@ void Game::fireworks_explosion() {
     }
 }
 
+void Game::Tick(float dt) {
+    // the stats overlay shows the particles of all steps of this frame
+    Particles->ResetStats();
+    StepAccumulator += dt;
+    unsigned int steps = 0;
+    for(; StepAccumulator >= SIMULATION_STEP && steps < MAX_SIMULATION_STEPS; steps++) {
+        this->StorePreviousPositions();
+        this->ProcessInput(SIMULATION_STEP);
+        this->Update(SIMULATION_STEP);
+        StepAccumulator -= SIMULATION_STEP;
+    }
+    // after a long frame the game slows down instead of running ever more steps to catch up
+    if(steps == MAX_SIMULATION_STEPS)
+        StepAccumulator = std::fmod(StepAccumulator, static_cast<double>(SIMULATION_STEP));
+    StepAlpha = static_cast<float>(StepAccumulator / SIMULATION_STEP);
+}
+
+void Game::StorePreviousPositions() {
+    Player->PreviousPosition = Player->Position;
+    Ball->PreviousPosition = Ball->Position;
+}
+
 void Game::Update(float dt) {
-    // ball movement
-    Ball->Move(dt, Width);
-    // check for collisions
-    DoCollisions();
-    // update particles
-    Particles->Update(dt, *Ball, 2, glm::vec2(Ball->Radius / 2.0f));
+    // update particles of all emitters on the workers, bursts queued from here on spawn next frame
+    Particles->SetEmitter(TrailEmitter, Ball->Position + glm::vec2(Ball->Radius / 2.0f), Ball->Velocity, true);
+    Particles->BeginUpdate(dt, Workers);
+    // move the ball and check for collisions
+    DoCollisions(dt);
     // update powerups
     this->UpdatePowerUps(dt);
+    Particles->EndUpdate();
+    // the pool balls use the workers after the particles are done with them
+    this->UpdateBalls(dt);
     // reduce shake time
     if (ShakeTime > 0.0f) {
         ShakeTime -= dt;
@@ -196,21 +316,14 @@ void Game::Update(float dt) {
     
     // explosion
     if(will_explode) {
+        // red first, then blue, changing every explosionFlash seconds
+        unsigned int flash = static_cast<unsigned int>((explosionWait - explosionTime) / explosionFlash);
+        unsigned int col = flash % 2 ? PALETTE_EXPLOSION_BLUE : PALETTE_EXPLOSION_RED;
         explosionTime -= dt;
-        
-        // change light color each step
-        // glm::vec3 col {0.78f, 0.4f, 0.1f};
-        glm::vec3 col {1.0f, 0.f, 0.0f};
-
-        if(!explosionColor)
-            // col = {0.8f, 0.8f, 0.1f};
-            col = {0.0f, 0.0f, 1.0f};
 
-        explosionColor = !explosionColor;
-
-        for(GameObject* brick : bricksToExplode)
-            if(!brick->Destroyed)
-                brick->Color = col;
+        for(unsigned int brick : bricksToExplode)
+            if(this->Levels[this->Level].Bricks().Live.Test(brick))
+                this->Levels[this->Level].SetBrickPalette(brick, col);
 
         if(explosionTime <= 0.0f) {
             fireworks_explosion();
@@ -218,11 +331,18 @@ void Game::Update(float dt) {
             // clean up
             will_explode = false;
             explosionTime = 0.0f;
-            explosionColor = 1;
             bricksToExplode.clear();
         }
     }
     
+    // a pool ball takes over from a lost ball, in the stress mode the pool balls do not play
+    if(Ball->Position.y >= this->Height && !this->StressBalls && Balls->Size()) {
+        unsigned int last = Balls->Size() - 1;
+        Ball->Position = Ball->PreviousPosition = glm::vec2(Balls->PositionX[last], Balls->PositionY[last]);
+        Ball->Velocity = glm::vec2(Balls->VelocityX[last], Balls->VelocityY[last]);
+        Balls->Remove(last);
+    }
+
     // check loss condition
     if(Ball->Position.y >= this->Height) { // bottom edge
         --this->Lives;
@@ -256,14 +376,14 @@ void Game::ProcessInput(float deltaTime) {
             this->KeysProcessed[GLFW_KEY_ENTER] = true;
         }
         if(this->Keys[GLFW_KEY_W] && !this->KeysProcessed[GLFW_KEY_W]) {
-            this->Level = (this->Level + 1) % 4;
+            this->Level = (this->Level + 1) % this->Levels.size();
             this->KeysProcessed[GLFW_KEY_W] = true;
         }
         if(this->Keys[GLFW_KEY_S] && !this->KeysProcessed[GLFW_KEY_S]) {
             if(this->Level > 0)
                 --this->Level;
             else
-                this->Level = 3;
+                this->Level = this->Levels.size() - 1;
             
             this->KeysProcessed[GLFW_KEY_S] = true;
         }
@@ -285,6 +405,12 @@ void Game::ProcessInput(float deltaTime) {
         }
     }
 
+    // toggle render statistics
+    if(this->Keys[GLFW_KEY_F3] && !this->KeysProcessed[GLFW_KEY_F3]) {
+        this->ShowStats = !this->ShowStats;
+        this->KeysProcessed[GLFW_KEY_F3] = true;
+    }
+
     if(State == GAME_ACTIVE) {
         float distance = PLAYER_VELOCITY * deltaTime;
         // move paddle
@@ -310,36 +436,62 @@ void Game::ProcessInput(float deltaTime) {
 }
 
 void Game::Render() {
+    FrameGLCounters = GLState::Counters;
+    GLState::ResetCounters();
+
+    // per frame uniforms of all shaders, written with a single buffer update
+    Frame->Data.Time = glfwGetTime();
+    Frame->Data.Confuse = Effects->Confuse;
+    Frame->Data.Chaos = Effects->Chaos;
+    Frame->Data.Shake = Effects->Shake;
+    Frame->Data.Grayscale = Effects->Grayscale;
+    Frame->Upload();
+
     // begin rendering to off screen renderer
     Effects->BeginRender();
 
+    // queue the scene, the layer of each command decides its draw order
     // draw background
-    Renderer->DrawSprite(ResourceManager::GetTexture("background"), glm::vec2(0.0f, 0.0f), glm::vec2(this->Width, this->Height), 0.0f);
-    // draw level
-    this->Levels[this->Level].Draw(*Renderer);
+    Queue->SubmitSprite(LAYER_BACKGROUND, nullptr, ResourceManager::GetTexture("background"), glm::vec2(0.0f, 0.0f), glm::vec2(this->Width, this->Height), 0.0f);
     // draw player
-    Player->Draw(*Renderer);
+    Player->Submit(*Queue, LAYER_OBJECTS, StepAlpha);
     // draw power ups
-    
-    for(PowerUp& powerup : this->PowerUps)
-        if(!powerup.Destroyed)
-            powerup.Draw(*Renderer);
+    FallingPowerUps->Submit(*Queue, (1.0f - StepAlpha) * SIMULATION_STEP);
 
-    // draw bricks
-    this->Levels[this->Level].Draw(*Renderer);
+    // draw bricks (over the power ups)
+    this->Levels[this->Level].Submit(*Queue, *Renderer);
     // draw particles
-    Particles->Draw();
+    Particles->Submit(*Queue);
     // draw ball
-    Ball->Draw(*Renderer);
+    Ball->Submit(*Queue, LAYER_BALL, StepAlpha);
+    Balls->Submit(*Queue, *Renderer);
+
+    // sort and draw everything in one pass
+    Queue->Execute();
+    this->FrameStats = Queue->Stats;
 
     Effects->EndRender(); // copy to normal FBO
 
-    Effects->Render(glfwGetTime()); // render to screen
+    Effects->Render(); // render to screen
 
     // render text (don't include in postprocessing)
     std::stringstream ss; ss << this->Lives;
     Text->RenderText("Lives:" + ss.str(), 5.0f, 5.0f, 1.0f);
 
+    if(this->ShowStats) {
+        std::stringstream stats;
+        stats << "Commands: " << this->FrameStats.Commands << "  State changes: " << this->FrameStats.StateChanges
+            << "  Draw calls: " << this->FrameStats.DrawCalls;
+        Text->RenderText(stats.str(), 5.0f, this->Height - 40.0f, 0.6f);
+        std::stringstream glStats;
+        glStats << "GL state calls issued: " << FrameGLCounters.Issued << "  avoided: " << FrameGLCounters.Avoided;
+        Text->RenderText(glStats.str(), 5.0f, this->Height - 20.0f, 0.6f);
+        std::stringstream particleStats;
+        particleStats << "Particles: " << Particles->LiveCount() << "  spawned: " << Particles->Stats.Spawned
+            << "  culled: " << Particles->Stats.Culled << "  refused: " << Particles->Stats.Refused;
+        Text->RenderText(particleStats.str(), 5.0f, this->Height - 60.0f, 0.6f);
+    }
+
     if(this->State == GAME_MENU) {
         Text->RenderText("Press ENTER to start", 250.0f, this->Height / 2.0f, 1.0f);
         Text->RenderText("Press W or S to select level", 245.0f, this->Height / 2.0f + 20.0f, 0.75f);
@@ -355,18 +507,14 @@ void Game::Render() {
         Text->RenderText("YOU DEER :(", 320.0f, this->Height / 2.0f - 20.0f, 1.0f, glm::vec3(1.0f, 0.0f, 0.0f));
         Text->RenderText("Press ENTER to retry or ESC to quit", 130.0f, this->Height / 2.0f, 1.0f, glm::vec3(1.0f, 1.0f, 0.0f));
     }
+
+    // the next frame writes its vertices to another part of the stream buffer
+    StreamBuffer::EndFrame();
 }
 
 void Game::ResetLevel()
 {
-    if (this->Level == 0)
-        this->Levels[0].Load("levels/one.lvl", this->Width, this->Height / 2);
-    else if (this->Level == 1)
-        this->Levels[1].Load("levels/two.lvl", this->Width, this->Height / 2);
-    else if (this->Level == 2)
-        this->Levels[2].Load("levels/three.lvl", this->Width, this->Height / 2);
-    else if (this->Level == 3)
-        this->Levels[3].Load("levels/four.lvl", this->Width, this->Height / 2);
+    this->Levels[this->Level].Load((std::string(FS_SRC_PATH) + LEVEL_FILES[this->Level]).c_str(), this->Width, this->Height / 2);
 
     this->Lives = 3;
 }
@@ -375,6 +523,7 @@ void Game::ResetPlayer() {
     // reset player / ball stats
     Player->Size = PLAYER_SIZE;
     Player->Position = glm::vec2(this->Width / 2.0f - PLAYER_SIZE.x / 2.0f, this->Height - PLAYER_SIZE.y);
+    Player->PreviousPosition = Player->Position;
     
     Ball->Radius = BALL_RADIUS;
     Ball->Size = glm::vec2(BALL_RADIUS * 2.0f, BALL_RADIUS * 2.0f);
@@ -388,6 +537,9 @@ void Game::ResetPlayer() {
     Ball->Color = glm::vec3(1.0f);
 
     this->PowerUps.clear();
+    FallingPowerUps->Clear();
+    if(!this->StressBalls)
+        Balls->Clear();
 }
 
 bool IsOtherPowerUpActive(std::vector<PowerUp> &powerUps, std::string type)
@@ -404,8 +556,9 @@ bool IsOtherPowerUpActive(std::vector<PowerUp> &powerUps, std::string type)
 }
 
 void Game::UpdatePowerUps(float dt) {
+    // falling down
+    FallingPowerUps->Fall(dt);
     for(PowerUp& powerUp : this->PowerUps) {
-        powerUp.Position += powerUp.Velocity * dt; // falling down
         if(powerUp.Activated) {
             powerUp.Duration -= dt;
 
@@ -468,13 +621,11 @@ void Game::UpdatePowerUps(float dt) {
                 // }
             }
         }
-
-        // Note: unactivated but undestroyed powerups should not be removed
-        // Remove all PowerUps from vector that are destroyed AND !activated (thus either off the map or finished)
-        // Note we use a lambda expression to remove each PowerUp which is destroyed and not activated
-        this->PowerUps.erase(std::remove_if(this->PowerUps.begin(), this->PowerUps.end(),
-            [](const PowerUp& powerUp) { return powerUp.Destroyed && !powerUp.Activated; }), this->PowerUps.end());
     }
+
+    // Remove all PowerUps whose effect is finished, in a single pass once all of them are updated
+    this->PowerUps.erase(std::remove_if(this->PowerUps.begin(), this->PowerUps.end(),
+        [](const PowerUp& powerUp) { return !powerUp.Activated; }), this->PowerUps.end());
 }
 
 // 1 in `chance` possibility
@@ -483,29 +634,31 @@ bool ShouldSpawn(unsigned int chance) {
     return random == 0;
 }
 
-void Game::SpawnPowerUps(GameObject& block) {
+void Game::SpawnPowerUps(glm::vec2 position) {
     const int positive_chance = 30;
     const int neg_chance = 20;
 
     if (ShouldSpawn(positive_chance)) 
-        this->PowerUps.push_back(PowerUp("speed", glm::vec3(0.5f, 0.5f, 1.0f), 0.0f, block.Position, ResourceManager::GetTexture("powerup_speed")));
+        FallingPowerUps->Add(PowerUp("speed", glm::vec3(0.5f, 0.5f, 1.0f), 0.0f, position, ResourceManager::GetTextureHandle("powerup_speed")));
     if (ShouldSpawn(positive_chance))
-        this->PowerUps.push_back(PowerUp("sticky", glm::vec3(1.0f, 0.5f, 1.0f), 20.0f, block.Position, ResourceManager::GetTexture("powerup_sticky")));
+        FallingPowerUps->Add(PowerUp("sticky", glm::vec3(1.0f, 0.5f, 1.0f), 20.0f, position, ResourceManager::GetTextureHandle("powerup_sticky")));
     if (ShouldSpawn(positive_chance))
-        this->PowerUps.push_back(PowerUp("pass-through", glm::vec3(0.5f, 1.0f, 0.5f), 10.0f, block.Position, ResourceManager::GetTexture("powerup_passthrough")));
+        FallingPowerUps->Add(PowerUp("pass-through", glm::vec3(0.5f, 1.0f, 0.5f), 10.0f, position, ResourceManager::GetTextureHandle("powerup_passthrough")));
     if (ShouldSpawn(positive_chance))
-        this->PowerUps.push_back(PowerUp("pad-size-increase", glm::vec3(1.0f, 0.6f, 0.4), 0.0f, block.Position, ResourceManager::GetTexture("powerup_increase")));
+        FallingPowerUps->Add(PowerUp("pad-size-increase", glm::vec3(1.0f, 0.6f, 0.4), 0.0f, position, ResourceManager::GetTextureHandle("powerup_increase")));
     if (ShouldSpawn(positive_chance))
-        this->PowerUps.push_back(PowerUp("ball-decrease", glm::vec3(1.0f, 0.3f, 0.3f), 20.0f, block.Position, ResourceManager::GetTexture("powerup_ball-decrease")));
+        FallingPowerUps->Add(PowerUp("ball-decrease", glm::vec3(1.0f, 0.3f, 0.3f), 20.0f, position, ResourceManager::GetTextureHandle("powerup_ball-decrease")));
     if (ShouldSpawn(positive_chance))
-        this->PowerUps.push_back(PowerUp("fireworks", glm::vec3(0.96f, 0.47f, 0.25f), explosionWait, block.Position, ResourceManager::GetTexture("powerup_fireworks")));
+        FallingPowerUps->Add(PowerUp("fireworks", glm::vec3(0.96f, 0.47f, 0.25f), explosionWait, position, ResourceManager::GetTextureHandle("powerup_fireworks")));
     if (ShouldSpawn(positive_chance))
-        this->PowerUps.push_back(PowerUp("ball-increase", glm::vec3(1.0f, 0.6f, 0.4), 10.0f, block.Position, ResourceManager::GetTexture("powerup_ball-increase")));
+        FallingPowerUps->Add(PowerUp("multi-ball", glm::vec3(0.6f, 0.8f, 1.0f), 0.0f, position, ResourceManager::GetTextureHandle("powerup_multi-ball")));
+    if (ShouldSpawn(positive_chance))
+        FallingPowerUps->Add(PowerUp("ball-increase", glm::vec3(1.0f, 0.6f, 0.4), 10.0f, position, ResourceManager::GetTextureHandle("powerup_ball-increase")));
     
     if (ShouldSpawn(neg_chance)) // Negative powerups should spawn more often
-        this->PowerUps.push_back(PowerUp("confuse", glm::vec3(1.0f, 0.3f, 0.3f), 15.0f, block.Position, ResourceManager::GetTexture("powerup_confuse")));
+        FallingPowerUps->Add(PowerUp("confuse", glm::vec3(1.0f, 0.3f, 0.3f), 15.0f, position, ResourceManager::GetTextureHandle("powerup_confuse")));
     if (ShouldSpawn(neg_chance))
-        this->PowerUps.push_back(PowerUp("chaos", glm::vec3(0.9f, 0.25f, 0.25f), 15.0f, block.Position, ResourceManager::GetTexture("powerup_chaos")));
+        FallingPowerUps->Add(PowerUp("chaos", glm::vec3(0.9f, 0.25f, 0.25f), 15.0f, position, ResourceManager::GetTextureHandle("powerup_chaos")));
 }
 
 int randrange(int min, int max) // range : [min, max]
@@ -525,6 +678,13 @@ void Game::ActivatePowerUp(PowerUp& powerUp, unsigned int width) {
     } else if(powerUp.Type == "pad-size-increase" && Player->Size.x <= (width / 2)) {
         // increase size only if below limit
         Player->Size.x += 50;
+    } else if(powerUp.Type == "multi-ball") {
+        // new balls leave from the ball, turned to both sides of its direction
+        for(unsigned int i = 0; i < MULTI_BALL_COUNT; i++) {
+            float angle = glm::radians(20.0f) * (i / 2 + 1) * (i % 2 ? -1.0f : 1.0f);
+            float c = std::cos(angle), s = std::sin(angle);
+            Balls->Add(Ball->Position, glm::vec2(c * Ball->Velocity.x - s * Ball->Velocity.y, s * Ball->Velocity.x + c * Ball->Velocity.y));
+        }
     } else if(powerUp.Type == "ball-increase") {
         Ball->Radius *= 2;
         Ball->Size *= 2;
@@ -544,13 +704,15 @@ void Game::ActivatePowerUp(PowerUp& powerUp, unsigned int width) {
 
         // random brick selection logic - explode upto n bricks
         int n = randrange(1, 7);
-        int chance = this->Levels[this->Level].Bricks.size() / n;
+        GameLevel& level = this->Levels[this->Level];
+        const BrickStore& bricks = level.Bricks();
+        int chance = bricks.Size() / n;
 
-        for(int i = 0; i < this->Levels[this->Level].Bricks.size(); i++) {
-            GameObject& brick = this->Levels[this->Level].Bricks[i];
-            if(!brick.Destroyed && !brick.IsSolid && bricksToExplode.size() < n && ShouldSpawn(chance))
-                bricksToExplode.push_back(&brick);
-        }
+        // only the live bricks are visited
+        bricks.Live.ForEach([&](unsigned int i) {
+            if(!bricks.Solid.Test(i) && bricksToExplode.size() < n && ShouldSpawn(chance))
+                bricksToExplode.push_back(i);
+        });
 
     }
 }
@@ -568,7 +730,8 @@ Direction VectorDirection(glm::vec2 target) {
     unsigned int best_match = -1;
 
     for(unsigned int i = 0; i < 4; i++) {
-        float dot_product = glm::dot(glm::normalize(target), compass[i]);
+        // the largest dot product is the same with or without normalizing target
+        float dot_product = glm::dot(target, compass[i]);
         if(dot_product > max) {
             max = dot_product;
             best_match = i;
@@ -612,6 +775,100 @@ Collision Game::CheckCollision(BallObject& one, GameObject& two) {
     // return glm::length(diff2) <= one.Radius;
 }
 
+// ball moves by `motion` and `two` is AABB. the ball touches the box when its center touches the
+// box grown by the radius with rounded corners (the Minkowski sum of the box and the ball)
+SweptCollision Game::SweepCollision(BallObject& one, GameObject& two, glm::vec2 motion) {
+    Collision touching = CheckCollision(one, two);
+    return SweepCollision(one, two.Position, two.Size, motion, std::get<0>(touching), -std::get<2>(touching));
+}
+
+SweptCollision Game::SweepCollision(BallObject& one, glm::vec2 position, glm::vec2 size, glm::vec2 motion, bool touching, glm::vec2 normal) {
+    SweptCollision miss = std::make_tuple(false, 1.0f, glm::vec2(0.0f));
+    if(motion == glm::vec2(0.0f))
+        return miss;
+
+    // already touching, it is an impact only if the ball moves further in
+    if(touching) {
+        glm::vec2 center = one.Position + one.Radius;
+        glm::vec2 half = size / 2.0f, offset = center - (position + half);
+        if(std::abs(offset.x) <= half.x && std::abs(offset.y) <= half.y) {
+            // the center is inside the box, it leaves through the face it is least deep behind
+            // (as in CollideCircle) and is pushed out to rest on that face
+            int axis = half.x - std::abs(offset.x) < half.y - std::abs(offset.y) ? 0 : 1;
+            normal = glm::vec2(0.0f);
+            normal[axis] = std::copysign(1.0f, offset[axis]);
+            one.Position[axis] = normal[axis] > 0.0f ? position[axis] + size[axis] : position[axis] - 2.0f * one.Radius;
+        }
+        normal = glm::normalize(normal);
+        if(glm::dot(motion, normal) < 0.0f)
+            return std::make_tuple(true, 0.0f, normal);
+        return miss;
+    }
+
+    // enter the grown box as if it had square corners
+    glm::vec2 center = one.Position + one.Radius;
+    glm::vec2 box_min = position, box_max = position + size;
+    glm::vec2 grown_min = box_min - one.Radius, grown_max = box_max + one.Radius;
+    float enter = 0.0f, exit = 1.0f;
+    int axis = -1; // axis of the side that is entered, -1 if the center starts inside the grown box
+    for(int i = 0; i < 2; i++) {
+        if(motion[i] == 0.0f) {
+            if(center[i] < grown_min[i] || center[i] > grown_max[i])
+                return miss;
+            continue;
+        }
+        float t0 = (grown_min[i] - center[i]) / motion[i];
+        float t1 = (grown_max[i] - center[i]) / motion[i];
+        if(t0 > t1)
+            std::swap(t0, t1);
+        if(t0 > enter) {
+            enter = t0;
+            axis = i;
+        }
+        exit = std::min(exit, t1);
+    }
+    if(enter > exit)
+        return miss;
+
+    // a side of the box, the contact is on the flat part of the grown box
+    glm::vec2 contact = center + motion * enter;
+    if(axis >= 0 && contact[1 - axis] >= box_min[1 - axis] && contact[1 - axis] <= box_max[1 - axis]) {
+        glm::vec2 normal(0.0f);
+        normal[axis] = motion[axis] > 0.0f ? -1.0f : 1.0f;
+        return std::make_tuple(true, enter, normal);
+    }
+
+    // a corner of the box, the ball center has to reach the circle around it
+    glm::vec2 offset = center - glm::clamp(contact, box_min, box_max);
+    float a = glm::dot(motion, motion);
+    float b = glm::dot(offset, motion);
+    float c = glm::dot(offset, offset) - one.Radius * one.Radius;
+    float discriminant = b * b - a * c;
+    if(discriminant < 0.0f)
+        return miss;
+    float t = (-b - std::sqrt(discriminant)) / a;
+    if(t < 0.0f || t > 1.0f)
+        return miss;
+    return std::make_tuple(true, t, (offset + motion * t) / one.Radius);
+}
+
+// ball moves by `motion` inside the left, top and right window edges
+SweptCollision Game::SweepWalls(BallObject& one, glm::vec2 motion) {
+    SweptCollision first = std::make_tuple(false, 1.0f, glm::vec2(0.0f));
+    glm::vec2 end = one.Position + motion;
+    if(motion.x < 0.0f && end.x < 0.0f)
+        first = std::make_tuple(true, std::max(-one.Position.x / motion.x, 0.0f), glm::vec2(1.0f, 0.0f));
+    else if(motion.x > 0.0f && end.x + one.Size.x > this->Width)
+        first = std::make_tuple(true, std::max((this->Width - one.Size.x - one.Position.x) / motion.x, 0.0f), glm::vec2(-1.0f, 0.0f));
+
+    if(motion.y < 0.0f && end.y < 0.0f) {
+        float t = std::max(-one.Position.y / motion.y, 0.0f);
+        if(t < std::get<1>(first))
+            first = std::make_tuple(true, t, glm::vec2(0.0f, 1.0f));
+    }
+    return first;
+}
+
 #define USE_COM false
 
 struct object_props {
@@ -632,115 +889,213 @@ std::pair<glm::vec2, glm::vec2> conservation_of_momentum(object_props one, objec
     return {vf_one, vf_two};
 }
 
-// Note: so far throughout the game, speed (i.e magnitude(velocity)) never changes however velocity vector keeps changing
-void Game::DoCollisions() {
-    for(GameObject& brick : Levels[Level].Bricks) {
-        if(!brick.Destroyed) {
-            Collision collision = CheckCollision(*Ball, brick);
-            if(std::get<0>(collision)) {
-                if(!brick.IsSolid) {
-                    brick.Destroyed = true;
-                    this->SpawnPowerUps(brick);
-                    ma_sound_start(&mySounds["bleep"]);        
-                } else {
-                    ShakeTime = 0.05f;
-                    Effects->Shake = true;
-                    ma_sound_start(&mySounds["solid"]);        
-                }
-                
-                // collision resolution
-                Direction dir = std::get<1>(collision); // up, down, left or right
-                glm::vec2 diff_vector = std::get<2>(collision); // difference of closest point from ball center
-                
-                // note: we reverse velocity components on collision
-                // this does not change the speed of the ball (speed = sqrt(x^2 + y^2))
-
-                if (!(Ball->PassThrough && !brick.IsSolid)) // don't do collision resolution on non-solid bricks if pass-through is activated
-                {
-                    if(dir == LEFT || dir == RIGHT) { // horizontal collision
-                        Ball->Velocity.x = -Ball->Velocity.x;
-
-                        // relocate
-                        float penetration = Ball->Radius - std::abs(diff_vector.x);
-                        if(dir == LEFT)
-                            Ball->Position.x += penetration;
-                        else
-                            Ball->Position.x -= penetration;
-                    } else { // vertical collision
-                        Ball->Velocity.y = -Ball->Velocity.y;
-                        
-                        // relocate
-                        float penetration = Ball->Radius - std::abs(diff_vector.y);
-                        if(dir == UP)
-                            Ball->Position.y -= penetration;
-                        else
-                            Ball->Position.y += penetration;
-                    }
-                }
-
-                // direction calculation by dot product method
-                // speed calculation by COM 
-                if(USE_COM) {
-                    // simulate COM for brick-ball
-                    object_props ball_aluminium = {5, Ball->Velocity, 0.8};
-                    object_props brick_clay = {7, glm::vec2(0.0f), 0.5};
-                    
-                    // the speed will always lessen due to restitution
-                    glm::vec2 com_v = conservation_of_momentum(ball_aluminium, brick_clay).first;
-                    // com_v /= 1.5f;
-                    
-                    std::cout << com_v.x << ' ' << com_v.y << ' ' << glm::length(com_v) << std::endl; 
-                    Ball->Velocity = glm::normalize(Ball->Velocity) * glm::length(com_v);
-                    Ball->Velocity *= 2.0f; // boost to match world space
-                }
+void Game::MoveBall(BallObject& ball, float dt, bool paddle, bool effects, std::vector<unsigned int>& candidates) {
+    // move the ball up to its first impact with a wall, brick or the paddle, resolve it and
+    // continue with the rest of the motion. fast balls can not skip over anything this way
+    float remaining = 1.0f; // part of the frame's motion still ahead of the ball
+    for(unsigned int impacts = 0; !ball.Stuck && remaining > 0.0f && impacts < MAX_BALL_IMPACTS; impacts++) {
+        glm::vec2 motion = ball.Velocity * dt * remaining;
+        glm::vec2 end = ball.Position + motion;
+
+        SweptCollision first = SweepWalls(ball, motion);
+        int target = -1; // index of the brick hit first, or one of the targets below
+        const int WALL = -1, PADDLE = -2;
+
+        // only the bricks on the tiles the ball sweeps over can be hit. the bricks the ball touches
+        // already are found SIMD_WIDTH bricks at a time, the candidates come in runs of neighbours
+        Levels[Level].QueryBricks(glm::min(ball.Position, end), glm::max(ball.Position, end) + ball.Radius * 2.0f, candidates);
+        // the live bits and the bounds are read for every candidate, the box only for the live ones
+        const BrickStore& bricks = Levels[Level].Bricks();
+        CircleContacts<SIMD_WIDTH> contacts;
+        unsigned int contactsFirst = -1;
+        for(unsigned int i : candidates) {
+            if(!bricks.Live.Test(i))
+                continue;
+            unsigned int lane = i % SIMD_WIDTH;
+            if(i - lane != contactsFirst) {
+                contactsFirst = i - lane;
+                contacts = CollideCircle<SIMD_WIDTH>(bricks.Bounds, contactsFirst, ball.Position + ball.Radius, ball.Radius);
+            }
+            glm::vec2 normal(contacts.NormalX[lane], contacts.NormalY[lane]);
+            const BrickInstance& brick = bricks.Instances[i];
+            SweptCollision collision = SweepCollision(ball, brick.Position, brick.Size, motion, contacts.Mask & (1u << lane), normal);
+            if(std::get<0>(collision) && (!std::get<0>(first) || std::get<1>(collision) < std::get<1>(first))) {
+                first = collision;
+                target = i;
             }
         }
-    }
-    
-    // check collisions on powerups and if so activate them
-    for(PowerUp& powerUp : this->PowerUps) {
-        if(!powerUp.Destroyed) {
-            if(powerUp.Position.y >= this->Height) {
-                powerUp.Destroyed = true;
-                powerUp.Activated = false;
-            } else if(CheckCollision(*Player, powerUp)) {
-                // collided with player, now activate powerup
-                ActivatePowerUp(powerUp, this->Width);
-                powerUp.Destroyed = true;
-                powerUp.Activated = true;
-                ma_sound_start(&mySounds["powerup"]);
+        if(paddle) {
+            SweptCollision collision = SweepCollision(ball, *Player, motion);
+            if(std::get<0>(collision) && (!std::get<0>(first) || std::get<1>(collision) < std::get<1>(first))) {
+                first = collision;
+                target = PADDLE;
             }
         }
+
+        if(!std::get<0>(first)) {
+            // not end, a sweep may have pushed the ball out of a box it was stuck in
+            ball.Position += motion;
+            break;
+        }
+        float t = std::get<1>(first);
+        ball.Position += motion * t;
+        remaining *= 1.0f - t;
+
+        glm::vec2 normal = std::get<2>(first);
+        if(target == PADDLE)
+            HitPaddle(ball, normal, effects);
+        else if(target == WALL)
+            ball.Velocity -= 2.0f * glm::dot(ball.Velocity, normal) * normal;
+        else
+            HitBrick(ball, target, normal, effects);
     }
+}
 
-    // check player paddle and ball collisions
-    Collision result = CheckCollision(*Ball, *Player);
-    if(!Ball->Stuck && std::get<0>(result)) {
-        // check where it hit the board, and change velocity based on where it hit the board
-        float centerBoard = Player->Position.x + Player->Size.x / 2.0f;
-        float distance = (Ball->Position.x + BALL_RADIUS) - centerBoard;
-        float percentage = distance / (Player->Size.x / 2.0f); // value between 0 and 1
-        // then move accordingly
-        float strength = 2.0f;
-        glm::vec2 oldVelocity = Ball->Velocity;
-        Ball->Velocity.x = INITIAL_BALL_VELOCITY.x * percentage * strength;
-        // Ball->Velocity.y = -Ball->Velocity.y;
-
-        object_props ball_aluminium = {5, Ball->Velocity, 0.8};
-        object_props ball_steel = {5, Ball->Velocity, 0.8};
-
-        // dont change speed on collision with paddle
-        Ball->Velocity = glm::normalize(Ball->Velocity) * glm::length(oldVelocity); // normalized 2d vector * old_length
+// Note: so far throughout the game, speed (i.e magnitude(velocity)) never changes however velocity vector keeps changing
+void Game::DoCollisions(float dt) {
+    if(!Ball->Stuck)
+        MoveBall(*Ball, dt, true, true, BrickCandidates);
+
+    // power ups below the screen are lost, only the ones above the paddle are checked for collisions
+    FallingPowerUps->RemoveBelow(this->Height);
+    FallingPowerUps->Overlapping(Player->Position, Player->Position + Player->Size, CaughtPowerUps);
+    for(unsigned int i : CaughtPowerUps) {
+        // collided with player, now activate powerup
+        PowerUp powerUp = FallingPowerUps->Get(i);
+        ActivatePowerUp(powerUp, this->Width);
+        Particles->Burst(PickupEmitter, powerUp.Position + powerUp.Size / 2.0f, glm::vec4(powerUp.Color, 1.0f));
+        powerUp.Destroyed = true;
+        powerUp.Activated = true;
+        ma_sound_start(&mySounds["powerup"]);
+        this->PowerUps.push_back(powerUp);
+        FallingPowerUps->Remove(i);
+    }
+    FallingPowerUps->Compact();
+}
+
+void Game::UpdateBalls(float dt) {
+    if(!Balls->Size())
+        return;
+    // the pool balls look and behave like the ball, unless they are the stress mode's
+    if(!this->StressBalls) {
+        Balls->Radius = Ball->Radius;
+        Balls->Color = Ball->Color;
+    }
+
+    // the paddle is tested against all balls in one pass, only the balls near it sweep against it
+    Balls->Near(Player->Position, Player->Position + Player->Size, dt, BallsNearPaddle);
+    if(this->StressBalls) {
+        // stress mode balls only bounce, so they can be moved on all threads at once
+        unsigned int count = Balls->Size();
+        unsigned int jobs = (count + BALL_JOB_SIZE - 1) / BALL_JOB_SIZE;
+        Workers->Dispatch(jobs, [this, dt, count](unsigned int job, unsigned int thread) {
+            this->MovePoolBalls(job * BALL_JOB_SIZE, std::min(count, (job + 1) * BALL_JOB_SIZE), dt, false, thread);
+        });
+        Workers->Wait();
+    } else {
+        this->MovePoolBalls(0, Balls->Size(), dt, true, 0);
+        // lost balls leave the pool
+        for(unsigned int i = Balls->Size(); i-- > 0;)
+            if(Balls->PositionY[i] >= this->Height)
+                Balls->Remove(i);
+    }
+
+    if(this->BallCollisions)
+        Balls->Collide();
+}
+
+void Game::MovePoolBalls(unsigned int begin, unsigned int end, float dt, bool effects, unsigned int thread) {
+    BallObject& ball = PoolBallScratch[thread];
+    ball.Radius = Balls->Radius;
+    ball.Size = glm::vec2(Balls->Radius * 2.0f);
+    ball.PassThrough = effects && Ball->PassThrough;
+    for(unsigned int i = begin; i < end; i++) {
+        ball.Position = glm::vec2(Balls->PositionX[i], Balls->PositionY[i]);
+        ball.Velocity = glm::vec2(Balls->VelocityX[i], Balls->VelocityY[i]);
+        ball.Stuck = false;
+        MoveBall(ball, dt, BallsNearPaddle[i], effects, PoolBallCandidates[thread]);
+
+        // stress mode balls are never lost, they bounce off the bottom edge as well
+        if(this->StressBalls && ball.Position.y + ball.Size.y > this->Height) {
+            ball.Position.y = this->Height - ball.Size.y;
+            ball.Velocity.y = -std::abs(ball.Velocity.y);
+        }
+        Balls->PositionX[i] = ball.Position.x;
+        Balls->PositionY[i] = ball.Position.y;
+        Balls->VelocityX[i] = ball.Velocity.x;
+        Balls->VelocityY[i] = ball.Velocity.y;
+    }
+}
+
+void Game::HitBrick(BallObject& ball, unsigned int index, glm::vec2 normal, bool effects) {
+    const BrickInstance& brick = Levels[Level].Bricks().Instances[index];
+    bool solid = Levels[Level].Bricks().Solid.Test(index);
+    // without effects the ball only bounces off
+    if(effects && !solid) {
+        Levels[Level].DestroyBrick(index);
+        Particles->Burst(ShatterEmitter, brick.Position + brick.Size / 2.0f, glm::vec4(BRICK_PALETTE[brick.Palette], 1.0f));
+        this->SpawnPowerUps(brick.Position);
+        ma_sound_start(&mySounds["bleep"]);        
+    } else if(effects) {
+        ShakeTime = 0.05f;
+        Effects->Shake = true;
+        ma_sound_start(&mySounds["solid"]);        
+    }
     
-        if(USE_COM)
-            Ball->Velocity *= 1.05f; // boost speed when ball touches paddle
+    // collision resolution
+    // note: we reflect the velocity about the surface normal
+    // this does not change the speed of the ball (speed = sqrt(x^2 + y^2))
+    if (!(ball.PassThrough && !solid)) // don't do collision resolution on non-solid bricks if pass-through is activated
+        ball.Velocity -= 2.0f * glm::dot(ball.Velocity, normal) * normal;
+
+    // direction calculation by dot product method
+    // speed calculation by COM 
+    if(USE_COM) {
+        // simulate COM for brick-ball
+        object_props ball_aluminium = {5, ball.Velocity, 0.8};
+        object_props brick_clay = {7, glm::vec2(0.0f), 0.5};
+        
+        // the speed will always lessen due to restitution
+        glm::vec2 com_v = conservation_of_momentum(ball_aluminium, brick_clay).first;
+        // com_v /= 1.5f;
         
-        // fix sticky paddle
-        Ball->Velocity.y = -1.0f * abs(Ball->Velocity.y);
+        std::cout << com_v.x << ' ' << com_v.y << ' ' << glm::length(com_v) << std::endl; 
+        ball.Velocity = glm::normalize(ball.Velocity) * glm::length(com_v);
+        ball.Velocity *= 2.0f; // boost to match world space
+    }
+}
 
-        // if Sticky powerup is activated, also stick ball to paddle once new velocity vectors were calculated
-        Ball->Stuck = Ball->Sticky;
+void Game::HitPaddle(BallObject& ball, glm::vec2 normal, bool effects) {
+    // check where it hit the board, and change velocity based on where it hit the board
+    float centerBoard = Player->Position.x + Player->Size.x / 2.0f;
+    float distance = (ball.Position.x + BALL_RADIUS) - centerBoard;
+    float percentage = distance / (Player->Size.x / 2.0f); // value between 0 and 1
+    // then move accordingly
+    float strength = 2.0f;
+    glm::vec2 oldVelocity = ball.Velocity;
+    ball.Velocity.x = INITIAL_BALL_VELOCITY.x * percentage * strength;
+    // ball.Velocity.y = -ball.Velocity.y;
+
+    object_props ball_aluminium = {5, ball.Velocity, 0.8};
+    object_props ball_steel = {5, ball.Velocity, 0.8};
+
+    // dont change speed on collision with paddle
+    ball.Velocity = glm::normalize(ball.Velocity) * glm::length(oldVelocity); // normalized 2d vector * old_length
+
+    if(USE_COM)
+        ball.Velocity *= 1.05f; // boost speed when ball touches paddle
+    
+    // fix sticky paddle
+    ball.Velocity.y = -1.0f * abs(ball.Velocity.y);
+
+    // a hit on the side can leave the ball heading into the paddle, bounce it off the side as well
+    float into = glm::dot(ball.Velocity, normal);
+    if(into < 0.0f)
+        ball.Velocity -= 2.0f * into * normal;
+
+    // if Sticky powerup is activated, also stick ball to paddle once new velocity vectors were calculated
+    ball.Stuck = ball.Sticky;
 
+    if(effects)
         ma_sound_start(&mySounds["bleep"]);
-    }
-}
\ No newline at end of file
+}
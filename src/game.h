@@ -12,6 +12,7 @@
 #include "game_object.h"
 #include "ball_object_collisions.h"
 #include "power_up.h"
+#include "render_queue.h"
 
 // the globals are available to game.cpp
 
@@ -34,6 +35,9 @@ enum Direction {
 // Defines a Collision typedef that represents collision data
 // <collision?, what direction?, difference vector center - closest point>
 typedef std::tuple<bool, Direction, glm::vec2> Collision; 
+// Defines a SweptCollision typedef that represents the first contact of a moving ball
+// <collision?, fraction of the motion before the contact, surface normal at the contact>
+typedef std::tuple<bool, float, glm::vec2> SweptCollision;
 
 // paddle state
 const glm::vec2 PLAYER_SIZE{100.0f, 20.0f};
@@ -46,6 +50,18 @@ const glm::vec2 INITIAL_BALL_VELOCITY(100.0f, -350.0f);
 // Radius of the ball object
 const float BALL_RADIUS = 12.5f;
 
+// the simulation advances in fixed steps of SIMULATION_STEP seconds, a frame runs
+// MAX_SIMULATION_STEPS at most and drops the time it could not catch up with
+const float SIMULATION_STEP = 1.0f / 240.0f;
+const unsigned int MAX_SIMULATION_STEPS = 8;
+
+// maximum number of live particles of all particle emitters together
+const unsigned int PARTICLE_BUDGET = 100000;
+
+// balls the multi-ball power up adds, and the radius of the stress mode balls
+const unsigned int MULTI_BALL_COUNT = 2;
+const float STRESS_BALL_RADIUS = 4.0f;
+
 // game holds all game-related state and functionality
 // combines all game realted data in a single class for easy acess to all components and manageability
 class Game {
@@ -58,8 +74,16 @@ public:
     std::vector<GameLevel> Levels;
     unsigned int Lives;
     unsigned int Level;
-    std::vector<PowerUp> PowerUps;
+    std::vector<PowerUp> PowerUps; // power ups caught by the paddle, kept while their effect lasts
     std::map<std::string, ma_sound> mySounds;
+    bool ShowStats; // show render queue statistics
+    RenderStats FrameStats; // render queue statistics of the last frame
+    unsigned int Framebuffer; // framebuffer the frame is presented to, 0 is the window (set before Init)
+    unsigned int WorkerThreads; // threads the simulation runs on besides the main thread (set before Init)
+    bool Deterministic; // the simulation gives the same results for any number of WorkerThreads (set before Init)
+    bool GpuParticles; // particles are simulated on the GPU with transform feedback (set before Init)
+    unsigned int StressBalls; // balls of the stress mode, 0 plays the normal game (set before Init)
+    bool BallCollisions; // the balls of the pool collide with each other
 
     // constructor / destructor
     Game(unsigned int width, unsigned int height);
@@ -68,24 +92,45 @@ public:
     void Init();
     void init_audio();
     // game loop
+    // runs the simulation steps that fit into the time that passed, the remainder carries over to the next frame
+    void Tick(float dt);
     void ProcessInput(float dt);
     void Update(float dt);
     void Render();
-    void DoCollisions();
+    // moves the main ball by its velocity, resolving each impact along the way in order
+    // (the balls of the pool are moved by UpdateBalls)
+    void DoCollisions(float dt);
+    // moves the balls of the pool and removes the lost ones
+    void UpdateBalls(float dt);
 
     void ResetPlayer();
     void ResetLevel();
 
     // powerups
-    void SpawnPowerUps(GameObject& block);
+    void SpawnPowerUps(glm::vec2 position);
     void UpdatePowerUps(float dt);
 
     // explosion effect requires audio
     void fireworks_explosion();
     void ActivatePowerUp(PowerUp& powerUp, unsigned int width);
 private:
+    // remembers where the interpolated objects are before a simulation step
+    void StorePreviousPositions();
     bool CheckCollision(GameObject& one, GameObject& two);
     Collision CheckCollision(BallObject& one, GameObject& two);
+    SweptCollision SweepCollision(BallObject& one, GameObject& two, glm::vec2 motion);
+    // same against the box [position, position + size], with the contact at the start already known.
+    // normal points from the box to the ball
+    SweptCollision SweepCollision(BallObject& one, glm::vec2 position, glm::vec2 size, glm::vec2 motion, bool touching, glm::vec2 normal);
+    SweptCollision SweepWalls(BallObject& one, glm::vec2 motion);
+    // moves a ball for dt and resolves its impacts. the paddle is only tested if paddle is set. without
+    // effects the ball only bounces, nothing else changes and it is safe to move balls on the workers
+    void MoveBall(BallObject& ball, float dt, bool paddle, bool effects, std::vector<unsigned int>& candidates);
+    // impact responses of a ball, normal points away from the surface that was hit
+    void HitBrick(BallObject& ball, unsigned int index, glm::vec2 normal, bool effects);
+    void HitPaddle(BallObject& ball, glm::vec2 normal, bool effects);
+    // moves the balls [begin, end) of the pool, thread selects the scratch state
+    void MovePoolBalls(unsigned int begin, unsigned int end, float dt, bool effects, unsigned int thread);
 };
 
 #endif
\ No newline at end of file
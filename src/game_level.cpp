@@ -1,12 +1,39 @@
 #include "game_level.h"
+#include "gl_state.h"
 
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
 #include <fstream>
 #include <sstream>
 #include <vector>
 
+constexpr UniformName UNIFORM_BLOCK_UV("blockUV");
+constexpr UniformName UNIFORM_BLOCK_SOLID_UV("blockSolidUV");
+
+// first word of a free-form level file
+const char* FREEFORM_KEYWORD = "freeform";
+
+// colors of the brick palette, indexed by BrickPalette / tile code
+const glm::vec3 BRICK_PALETTE[PALETTE_SIZE] = {
+    glm::vec3(1.0f),                // default
+    glm::vec3(0.8f, 0.8f, 0.7f),    // solid
+    glm::vec3(0.2f, 0.6f, 1.0f),    // 2
+    glm::vec3(0.0f, 0.7f, 0.0f),    // 3
+    glm::vec3(0.8f, 0.8f, 0.4f),    // 4
+    glm::vec3(1.0f, 0.5f, 0.0f),    // 5
+    glm::vec3(1.0f, 0.0f, 0.0f),    // explosion red
+    glm::vec3(0.0f, 0.0f, 1.0f)     // explosion blue
+};
+
 void GameLevel::Load(const char* file, unsigned int levelWidth, unsigned int levelHeight) {
     // clear old data
-    this->Bricks.clear();
+    this->bricks.Clear();
+    this->tileBricks.clear();
+    this->liveDestructible = 0;
+    this->tree.Clear();
+    this->freeForm = false;
+    this->gridColumns = this->gridRows = 0;
     // load from file
     unsigned int tileCode;
     GameLevel level;
@@ -16,6 +43,15 @@ void GameLevel::Load(const char* file, unsigned int levelWidth, unsigned int lev
     std::vector<std::vector<unsigned int>> tileData;
 
     if(fstream) {
+        // free-form levels start with a keyword, tile levels with a row of tile codes
+        std::string keyword;
+        if(fstream >> keyword && keyword == FREEFORM_KEYWORD) {
+            this->initFreeForm(fstream, levelWidth, levelHeight);
+            return;
+        }
+        fstream.clear();
+        fstream.seekg(0);
+
         while(std::getline(fstream, line)) {
             std::istringstream sstream{line};
             std::vector<unsigned int> row;
@@ -29,18 +65,91 @@ void GameLevel::Load(const char* file, unsigned int levelWidth, unsigned int lev
     
 }
 
-void GameLevel::Draw(SpriteRenderer& renderer) {
-    for(GameObject& tile : this->Bricks)
-        if(!tile.Destroyed)
-            tile.Draw(renderer);
+unsigned int GameLevel::Draw(SpriteRenderer& renderer) {
+    // only the span from the first to the last live brick is drawn
+    unsigned int first = this->bricks.Live.First();
+    if(first == this->bricks.Live.Size())
+        return 0;
+    unsigned int count = this->bricks.Live.Last() - first + 1;
+
+    // sprites batched so far have to be drawn below the bricks
+    renderer.Flush();
+
+    // both brick sprites live on the same atlas page
+    TextureRegion& block = ResourceManager::GetTexture("block");
+    TextureRegion& blockSolid = ResourceManager::GetTexture("block_solid");
+
+    Shader& shader = ResourceManager::GetShader("brick");
+    shader.Use();
+    shader.SetVector4f(UNIFORM_BLOCK_UV, block.UV);
+    shader.SetVector4f(UNIFORM_BLOCK_SOLID_UV, blockSolid.UV);
+    GLState::ActiveTexture(0);
+    block.Texture.Bind();
+
+    // destroyed bricks inside the span are collapsed in the vertex shader
+    GLState::BindVertexArray(this->VAO);
+    if(first != this->firstInstance)
+        this->pointInstances(first);
+    glDrawArraysInstanced(GL_TRIANGLES, 0, 6, count);
+    return 1;
+}
+
+void GameLevel::Submit(RenderQueue& queue, SpriteRenderer& renderer) {
+    uint64_t key = RenderQueue::MakeKey(LAYER_LEVEL, BLEND_ALPHA, ResourceManager::GetShader("brick").ID,
+        ResourceManager::GetTexture("block").Texture.ID);
+    queue.Submit(key, this, [this, &renderer]() { return this->Draw(renderer); });
 }
 
 bool GameLevel::isCompleted() {
-    for(GameObject& tile : this->Bricks)
-        if(!tile.IsSolid & !tile.Destroyed)
-            return false;
-        
-    return true;
+    return this->liveDestructible == 0;
+}
+
+void GameLevel::DestroyBrick(unsigned int index) {
+    if(!this->bricks.Live.Test(index))
+        return;
+    if(!this->bricks.Solid.Test(index))
+        this->liveDestructible--;
+    this->bricks.Destroy(index);
+    if(this->freeForm)
+        this->tree.Refit(this->bricks, index);
+    this->updateInstance(index);
+}
+
+void GameLevel::SetBrickPalette(unsigned int index, unsigned int palette) {
+    if(this->bricks.Instances[index].Palette == palette)
+        return;
+
+    this->bricks.Instances[index].Palette = palette;
+    this->updateInstance(index);
+}
+
+void GameLevel::QueryBricks(glm::vec2 min, glm::vec2 max, std::vector<unsigned int>& out) const {
+    if(this->freeForm) {
+        this->tree.Query(min, max, out);
+        return;
+    }
+    out.clear();
+    glm::vec2 extent = this->tileSize * glm::vec2(this->gridColumns, this->gridRows);
+    if(this->tileBricks.empty() || max.x < 0.0f || max.y < 0.0f || min.x > extent.x || min.y > extent.y)
+        return;
+
+    // tile range of the box, clamped to the grid
+    int firstColumn = std::max(0, static_cast<int>(std::floor(min.x / this->tileSize.x)));
+    int firstRow = std::max(0, static_cast<int>(std::floor(min.y / this->tileSize.y)));
+    int lastColumn = std::min<int>(this->gridColumns - 1, std::floor(max.x / this->tileSize.x));
+    int lastRow = std::min<int>(this->gridRows - 1, std::floor(max.y / this->tileSize.y));
+
+    // bricks were created row by row, so walking the tiles the same way keeps them sorted
+    for(int row = firstRow; row <= lastRow; row++)
+        for(int column = firstColumn; column <= lastColumn; column++) {
+            int brick = this->tileBricks[row * this->gridColumns + column];
+            if(brick >= 0)
+                out.push_back(brick);
+        }
+}
+
+const BrickStore& GameLevel::Bricks() const {
+    return this->bricks;
 }
 
 void GameLevel::init(std::vector<std::vector<unsigned int>> tileData, unsigned int levelWidth, unsigned int levelHeight) {
@@ -50,35 +159,115 @@ void GameLevel::init(std::vector<std::vector<unsigned int>> tileData, unsigned i
     float unit_width = levelWidth / static_cast<float>(width);
     float unit_height = levelHeight / static_cast<float>(height);
 
+    this->gridColumns = width;
+    this->gridRows = height;
+    this->tileSize = glm::vec2(unit_width, unit_height);
+    this->tileBricks.assign(width * height, -1);
+
     // initialize level tiles
     for(unsigned int y = 0; y < height; y++) {
         for(unsigned int x = 0; x < width; x++) {
-            if(tileData[y][x] == 1) { // solid
-                glm::vec2 pos{unit_width * x, unit_height * y};
-                glm::vec2 size{unit_width, unit_height};
-                glm::vec3 solid_color{0.8f, 0.8f, 0.7f};
-                GameObject obj{pos, size, ResourceManager::GetTexture("block_solid"), solid_color};
-                obj.IsSolid = true;
-                this->Bricks.push_back(obj);
-            } else if(tileData[y][x] > 1) {
-                glm::vec3 color = glm::vec3(1.0f);
-
-                if (tileData[y][x] == 2)
-                    color = glm::vec3(0.2f, 0.6f, 1.0f);
-                else if (tileData[y][x] == 3)
-                    color = glm::vec3(0.0f, 0.7f, 0.0f);
-                else if (tileData[y][x] == 4)
-                    color = glm::vec3(0.8f, 0.8f, 0.4f);
-                else if (tileData[y][x] == 5)
-                    color = glm::vec3(1.0f, 0.5f, 0.0f);
-
-                glm::vec2 pos(unit_width * x, unit_height * y);
-                glm::vec2 size(unit_width, unit_height);
-                GameObject obj{pos, size, ResourceManager::GetTexture("block"), color};
-                obj.IsSolid = false;
-
-                this->Bricks.push_back(obj);
+            if(tileData[y][x] > 0) {
+                this->tileBricks[y * width + x] = this->bricks.Size();
+                this->addBrick(glm::vec2(unit_width * x, unit_height * y), glm::vec2(unit_width, unit_height), tileData[y][x]);
             }
         }
     }
+
+    this->initBricks();
+}
+
+void GameLevel::initFreeForm(std::istream& stream, unsigned int levelWidth, unsigned int levelHeight) {
+    // the bricks are placed in an area of the size given after the keyword, scaled to the level size
+    glm::vec2 area;
+    if(!(stream >> area.x >> area.y) || area.x <= 0.0f || area.y <= 0.0f)
+        return;
+    glm::vec2 scale(levelWidth / area.x, levelHeight / area.y);
+
+    glm::vec2 pos, size;
+    unsigned int tileCode;
+    while(stream >> pos.x >> pos.y >> size.x >> size.y >> tileCode)
+        if(tileCode > 0)
+            this->addBrick(pos * scale, size * scale, tileCode);
+
+    // store the bricks in the order of the tree's leaves
+    std::vector<unsigned int> order;
+    this->tree.Build(this->bricks, order);
+    this->bricks.Reorder(order);
+    this->freeForm = true;
+
+    this->initBricks();
+}
+
+void GameLevel::addBrick(glm::vec2 pos, glm::vec2 size, unsigned int tileCode) {
+    if(tileCode == 1) { // solid
+        this->bricks.Add(pos, size, PALETTE_SOLID, true);
+    } else {
+        unsigned int palette = PALETTE_DEFAULT;
+
+        // tile codes 2..5 are colored bricks
+        if (tileCode <= 5)
+            palette = tileCode;
+
+        this->bricks.Add(pos, size, palette, false);
+    }
+}
+
+void GameLevel::initBricks() {
+    this->bricks.Build();
+    this->liveDestructible = this->bricks.Live.Count() - this->bricks.Solid.Count();
+
+    this->initRenderData();
+}
+
+void GameLevel::initRenderData() {
+    if(this->VAO == 0) {
+        float vertices[] = {
+            // pos          // tex
+            0.0f, 1.0f,     0.0f, 1.0f,
+            1.0f, 0.0f,     1.0f, 0.0f,
+            0.0f, 0.0f,     0.0f, 0.0f,
+
+            0.0f, 1.0f,     0.0f, 1.0f,
+            1.0f, 1.0f,     1.0f, 1.0f,
+            1.0f, 0.0f,     1.0f, 0.0f,
+        };
+
+        glGenVertexArrays(1, &this->VAO);
+        glGenBuffers(1, &this->quadVBO);
+        glGenBuffers(1, &this->instanceVBO);
+
+        GLState::BindVertexArray(this->VAO);
+        // unit quad
+        GLState::BindBuffer(GL_ARRAY_BUFFER, this->quadVBO);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
+
+        glEnableVertexAttribArray(1);
+        glVertexAttribDivisor(1, 1);
+        glEnableVertexAttribArray(2);
+        glVertexAttribDivisor(2, 1);
+    }
+
+    // the whole level is uploaded once, afterwards only single bricks are updated
+    GLState::BindBuffer(GL_ARRAY_BUFFER, this->instanceVBO);
+    glBufferData(GL_ARRAY_BUFFER, this->bricks.Instances.size() * sizeof(BrickInstance), this->bricks.Instances.data(), GL_DYNAMIC_DRAW);
+    GLState::BindVertexArray(this->VAO);
+    this->pointInstances(0);
+}
+
+void GameLevel::pointInstances(unsigned int first) {
+    // per instance <vec2 position, vec2 size> and <uint palette, uint flags>, GL 3.3 has no base instance
+    // so the attributes start at the first instance instead
+    size_t offset = first * sizeof(BrickInstance);
+    GLState::BindBuffer(GL_ARRAY_BUFFER, this->instanceVBO);
+    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(BrickInstance), (void*)(offset + offsetof(BrickInstance, Position)));
+    glVertexAttribIPointer(2, 2, GL_UNSIGNED_INT, sizeof(BrickInstance), (void*)(offset + offsetof(BrickInstance, Palette)));
+    this->firstInstance = first;
+}
+
+void GameLevel::updateInstance(unsigned int index) {
+    GLState::BindBuffer(GL_ARRAY_BUFFER, this->instanceVBO);
+    glBufferSubData(GL_ARRAY_BUFFER, index * sizeof(BrickInstance), sizeof(BrickInstance), &this->bricks.Instances[index]);
 }
\ No newline at end of file
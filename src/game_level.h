@@ -1,31 +1,93 @@
 #ifndef GAMELEVEL_H
 #define GAMELEVEL_H
 
+#include <istream>
 #include <vector>
 
 #include <glad/glad.h>
 #include <glm/glm.hpp>
 
-#include "game_object.h"
+#include "brick_store.h"
+#include "brick_bvh.h"
 #include "sprite_renderer.h"
+#include "render_queue.h"
 #include "resource_manager.h"
 
+// brick palette entries, tile codes 2..5 map directly onto their palette index
+enum BrickPalette {
+    PALETTE_DEFAULT = 0,
+    PALETTE_SOLID = 1,
+    PALETTE_EXPLOSION_RED = 6,
+    PALETTE_EXPLOSION_BLUE = 7,
+    PALETTE_SIZE = 8
+};
+
+// colors of the brick palette, uploaded to the brick shader
+extern const glm::vec3 BRICK_PALETTE[PALETTE_SIZE];
+
 /// GameLevel holds all Tiles as part of a Breakout level and 
 /// hosts functionality to Load/render levels from the harddisk.
+/// A level file is either a grid of tile codes, one line per row, or a
+/// free-form level: the keyword freeform, the width and height of the area
+/// the bricks are placed in, then one "x y width height tile-code" per brick.
+/// The bricks are stored as components in a BrickStore. All bricks of the
+/// level are drawn with a single instanced draw call straight from its
+/// instances, the buffer is only partially updated when a brick changes.
+/// The bricks stay on the tile grid they were loaded from, which serves as the
+/// broadphase of the collision tests. Free-form bricks are indexed by a BVH
+/// instead, and stored in the order of its leaves. The live destructible
+/// bricks are counted, the count is updated when a brick is destroyed.
 class GameLevel {
 public:
-    std::vector<GameObject> Bricks;
-    GameLevel() {}
+    GameLevel() : gridColumns(0), gridRows(0), tileSize(0.0f), freeForm(false), liveDestructible(0), VAO(0), quadVBO(0), instanceVBO(0), firstInstance(0) {}
     
     // load level from file
     void Load(const char* file, unsigned int levelWidth, unsigned int levelHeight);
-    // render level
-    void Draw(SpriteRenderer& renderer);
-    // check if the level is completed (all non solid tiles are destroyed)
+    // render level, returns the number of draw calls issued
+    unsigned int Draw(SpriteRenderer& renderer);
+    // queue the level for the frame's render queue
+    void Submit(RenderQueue& queue, SpriteRenderer& renderer);
+    // check if the level is completed (all non solid tiles are destroyed), O(1)
     bool isCompleted();
+    // destroys a brick and re-uploads only its instance
+    void DestroyBrick(unsigned int index);
+    // changes the palette color of a brick and re-uploads only its instance
+    void SetBrickPalette(unsigned int index, unsigned int palette);
+    // replaces the contents of out with the bricks (destroyed ones included) on the tiles, or in
+    // the BVH leaves of a free-form level, overlapping the box [min, max], in ascending order
+    void QueryBricks(glm::vec2 min, glm::vec2 max, std::vector<unsigned int>& out) const;
+    // components of the bricks by brick index, changed through the functions above only
+    const BrickStore& Bricks() const;
 private:
+    BrickStore bricks;
+    // brick index of every tile (row * gridColumns + column), -1 for empty tiles
+    std::vector<int> tileBricks;
+    unsigned int gridColumns, gridRows;
+    glm::vec2 tileSize;
+    // bricks of a free-form level
+    bool freeForm;
+    BrickBVH tree;
+    unsigned int liveDestructible;
+
+    // render state (shared by copies of the level, never deleted as levels live as long as the game)
+    unsigned int VAO, quadVBO, instanceVBO;
+    // first instance the instance attributes point at
+    unsigned int firstInstance;
+
     // initialize level from tile data
     void init(std::vector<std::vector<unsigned int>> tileData, unsigned int levelWidth, unsigned int levelHeight);
+    // initialize a free-form level from the rest of its file
+    void initFreeForm(std::istream& stream, unsigned int levelWidth, unsigned int levelHeight);
+    // adds the brick of a tile code
+    void addBrick(glm::vec2 pos, glm::vec2 size, unsigned int tileCode);
+    // sets up the hot components and render data once all bricks are added
+    void initBricks();
+    // creates the buffers on first use and uploads all instances
+    void initRenderData();
+    // uploads the byte range of a single instance
+    void updateInstance(unsigned int index);
+    // points the instance attributes of the VAO at the instance first
+    void pointInstances(unsigned int first);
 };
 
 #endif
\ No newline at end of file
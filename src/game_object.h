@@ -6,6 +6,7 @@
 
 #include "texture.h"
 #include "sprite_renderer.h"
+#include "render_queue.h"
 
 // Container object for holding all state relevant for a single
 // game object entity. Each object in the game likely needs the
@@ -17,21 +18,24 @@ public:
     // which is equal to (screen_coords_moved / seconds) since both spaces have the same dimensions
     // in our game
     glm::vec2 Position, Size, Velocity;
+    // position before the last simulation step, rendering interpolates from it to Position
+    glm::vec2 PreviousPosition;
     glm::vec3 Color;
 
     float Rotation;
-    bool IsSolid;
     bool Destroyed;
 
-    // render state
-    Texture2D Sprite;
+    // render state, the sprite is a handle into the ResourceManager's texture table
+    TextureHandle Sprite;
 
     // constructors
     GameObject();
-    GameObject(glm::vec2 pos, glm::vec2 size, Texture2D sprite, glm::vec3 color = glm::vec3(1.0f), glm::vec2 velocity = glm::vec2(0.0f, 0.0f));
+    GameObject(glm::vec2 pos, glm::vec2 size, TextureHandle sprite, glm::vec3 color = glm::vec3(1.0f), glm::vec2 velocity = glm::vec2(0.0f, 0.0f));
 
     // draw sprite
-    virtual void Draw(SpriteRenderer& renderer); // virtual method can be overwritten by a child class
+    void Draw(SpriteRenderer& renderer);
+    // queue sprite for the frame's render queue, alpha is how far rendering is between PreviousPosition and Position
+    void Submit(RenderQueue& queue, RenderLayer layer, float alpha = 1.0f);
 };
 
 #endif
\ No newline at end of file
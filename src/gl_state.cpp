@@ -0,0 +1,164 @@
+#include "gl_state.h"
+
+// state that is not known yet, comparing anything against it issues the call
+const unsigned int UNKNOWN = 0xFFFFFFFF;
+
+// instantiate static variables
+GLStateCounters GLState::Counters = { 0, 0 };
+unsigned int GLState::program = UNKNOWN;
+unsigned int GLState::activeUnit = UNKNOWN;
+unsigned int GLState::textures[GL_STATE_TEXTURE_UNITS]; // a fresh context has texture 0 bound on every unit
+unsigned int GLState::vao = UNKNOWN;
+unsigned int GLState::arrayBuffer = UNKNOWN;
+unsigned int GLState::uniformBuffer = UNKNOWN;
+unsigned int GLState::feedbackBuffer = UNKNOWN;
+unsigned int GLState::readFramebuffer = UNKNOWN;
+unsigned int GLState::drawFramebuffer = UNKNOWN;
+int GLState::blend = -1;
+GLenum GLState::blendSrc = UNKNOWN;
+GLenum GLState::blendDst = UNKNOWN;
+
+bool GLState::change(unsigned int& cached, unsigned int value) {
+    if(cached == value) {
+        Counters.Avoided++;
+        return false;
+    }
+    cached = value;
+    Counters.Issued++;
+    return true;
+}
+
+void GLState::UseProgram(unsigned int program) {
+    if(change(GLState::program, program))
+        glUseProgram(program);
+}
+
+void GLState::ActiveTexture(unsigned int unit) {
+    if(change(activeUnit, unit))
+        glActiveTexture(GL_TEXTURE0 + unit);
+}
+
+void GLState::BindTexture(unsigned int texture) {
+    // the first bind before any ActiveTexture call happens on the GL default unit 0
+    if(activeUnit == UNKNOWN)
+        ActiveTexture(0);
+    // units past the tracked ones are passed through
+    if(activeUnit >= GL_STATE_TEXTURE_UNITS) {
+        Counters.Issued++;
+        glBindTexture(GL_TEXTURE_2D, texture);
+    } else if(change(textures[activeUnit], texture)) {
+        glBindTexture(GL_TEXTURE_2D, texture);
+    }
+}
+
+void GLState::BindVertexArray(unsigned int vao) {
+    if(change(GLState::vao, vao))
+        glBindVertexArray(vao);
+}
+
+void GLState::BindBuffer(GLenum target, unsigned int buffer) {
+    unsigned int* cached = nullptr;
+    if(target == GL_ARRAY_BUFFER)
+        cached = &arrayBuffer;
+    else if(target == GL_UNIFORM_BUFFER)
+        cached = &uniformBuffer;
+    else if(target == GL_TRANSFORM_FEEDBACK_BUFFER)
+        cached = &feedbackBuffer;
+
+    if(!cached) {
+        Counters.Issued++;
+        glBindBuffer(target, buffer);
+    } else if(change(*cached, buffer)) {
+        glBindBuffer(target, buffer);
+    }
+}
+
+void GLState::BindFramebuffer(GLenum target, unsigned int framebuffer) {
+    if(target == GL_FRAMEBUFFER) {
+        if(readFramebuffer == framebuffer && drawFramebuffer == framebuffer) {
+            Counters.Avoided++;
+            return;
+        }
+        readFramebuffer = drawFramebuffer = framebuffer;
+        Counters.Issued++;
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    } else if(change(target == GL_READ_FRAMEBUFFER ? readFramebuffer : drawFramebuffer, framebuffer)) {
+        glBindFramebuffer(target, framebuffer);
+    }
+}
+
+void GLState::SetBlend(bool enabled) {
+    if(blend == static_cast<int>(enabled)) {
+        Counters.Avoided++;
+        return;
+    }
+    blend = enabled;
+    Counters.Issued++;
+    if(enabled)
+        glEnable(GL_BLEND);
+    else
+        glDisable(GL_BLEND);
+}
+
+void GLState::BlendFunc(GLenum sfactor, GLenum dfactor) {
+    if(blendSrc == sfactor && blendDst == dfactor) {
+        Counters.Avoided++;
+        return;
+    }
+    blendSrc = sfactor;
+    blendDst = dfactor;
+    Counters.Issued++;
+    glBlendFunc(sfactor, dfactor);
+}
+
+void GLState::DeleteProgram(unsigned int program) {
+    if(GLState::program == program)
+        GLState::program = UNKNOWN;
+    glDeleteProgram(program);
+}
+
+void GLState::DeleteTexture(unsigned int texture) {
+    // deleted textures are unbound from every unit
+    for(unsigned int i = 0; i < GL_STATE_TEXTURE_UNITS; i++)
+        if(textures[i] == texture)
+            textures[i] = 0;
+    glDeleteTextures(1, &texture);
+}
+
+void GLState::DeleteVertexArray(unsigned int vao) {
+    if(GLState::vao == vao)
+        GLState::vao = 0;
+    glDeleteVertexArrays(1, &vao);
+}
+
+void GLState::DeleteBuffer(unsigned int buffer) {
+    if(arrayBuffer == buffer)
+        arrayBuffer = 0;
+    if(uniformBuffer == buffer)
+        uniformBuffer = 0;
+    if(feedbackBuffer == buffer)
+        feedbackBuffer = 0;
+    glDeleteBuffers(1, &buffer);
+}
+
+void GLState::DeleteFramebuffer(unsigned int framebuffer) {
+    if(readFramebuffer == framebuffer)
+        readFramebuffer = 0;
+    if(drawFramebuffer == framebuffer)
+        drawFramebuffer = 0;
+    glDeleteFramebuffers(1, &framebuffer);
+}
+
+void GLState::Reset() {
+    program = activeUnit = vao = UNKNOWN;
+    for(unsigned int i = 0; i < GL_STATE_TEXTURE_UNITS; i++)
+        textures[i] = UNKNOWN;
+    arrayBuffer = uniformBuffer = feedbackBuffer = UNKNOWN;
+    readFramebuffer = drawFramebuffer = UNKNOWN;
+    blend = -1;
+    blendSrc = blendDst = UNKNOWN;
+}
+
+void GLState::ResetCounters() {
+    Counters = { 0, 0 };
+}
\ No newline at end of file
@@ -0,0 +1,64 @@
+#ifndef GL_STATE_H
+#define GL_STATE_H
+
+#include <glad/glad.h>
+
+// number of texture units tracked by the state cache
+const unsigned int GL_STATE_TEXTURE_UNITS = 16;
+
+// counts the state changes that reached the driver and the ones that were skipped
+struct GLStateCounters {
+    unsigned int Issued;
+    unsigned int Avoided;
+};
+
+// a static singleton GLState class that mirrors the bound GL objects and blend
+// state, so binding something that is already bound never reaches the driver.
+// all code that changes the tracked state must go through this class, otherwise
+// the cache has to be invalidated with Reset(). all functions and state are static.
+class GLState {
+public:
+    static GLStateCounters Counters;
+
+    static void UseProgram(unsigned int program);
+    // selects the active texture unit (0 based, not GL_TEXTURE0 based)
+    static void ActiveTexture(unsigned int unit);
+    // binds a 2D texture to the active texture unit, binds on units past GL_STATE_TEXTURE_UNITS are not cached
+    static void BindTexture(unsigned int texture);
+    static void BindVertexArray(unsigned int vao);
+    // binds a buffer, only GL_ARRAY_BUFFER, GL_UNIFORM_BUFFER and GL_TRANSFORM_FEEDBACK_BUFFER
+    // are cached (GL_ELEMENT_ARRAY_BUFFER is vertex array state and is passed through)
+    static void BindBuffer(GLenum target, unsigned int buffer);
+    // binds a framebuffer to GL_FRAMEBUFFER, GL_READ_FRAMEBUFFER or GL_DRAW_FRAMEBUFFER
+    static void BindFramebuffer(GLenum target, unsigned int framebuffer);
+    static void SetBlend(bool enabled);
+    static void BlendFunc(GLenum sfactor, GLenum dfactor);
+
+    // delete GL objects and forget them if they are currently bound
+    static void DeleteProgram(unsigned int program);
+    static void DeleteTexture(unsigned int texture);
+    static void DeleteVertexArray(unsigned int vao);
+    static void DeleteBuffer(unsigned int buffer);
+    static void DeleteFramebuffer(unsigned int framebuffer);
+
+    // forgets all cached state, the next call of every function reaches the driver
+    static void Reset();
+    static void ResetCounters();
+private:
+    GLState() {}
+
+    static unsigned int program;
+    static unsigned int activeUnit;
+    static unsigned int textures[GL_STATE_TEXTURE_UNITS];
+    static unsigned int vao;
+    static unsigned int arrayBuffer, uniformBuffer, feedbackBuffer;
+    static unsigned int readFramebuffer, drawFramebuffer;
+    static int blend; // -1 unknown, 0 disabled, 1 enabled
+    static GLenum blendSrc, blendDst;
+
+    // compares a cached value with a new one, updates the cache and the counters,
+    // returns true if the call has to reach the driver
+    static bool change(unsigned int& cached, unsigned int value);
+};
+
+#endif
\ No newline at end of file
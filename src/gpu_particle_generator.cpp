@@ -0,0 +1,157 @@
+#include "gpu_particle_generator.h"
+
+#include <algorithm>
+#include <cstddef>
+
+#include "gl_state.h"
+#include "resource_manager.h"
+
+static_assert(offsetof(ParticleFeedbackSpawn, Life) == 48 && sizeof(ParticleFeedbackSpawn) == 64,
+    "ParticleFeedbackSpawn must match the std140 layout");
+static_assert(offsetof(ParticleSpawnBlock, SpawnCount) == 64 * GPU_PARTICLE_SPAWNS,
+    "ParticleSpawnBlock must match the std140 layout");
+
+constexpr UniformName UNIFORM_UV_RECT("uvRect");
+
+GpuParticleGenerator::GpuParticleGenerator(Shader shader, Shader updateShader, TextureHandle texture, unsigned int amount, uint32_t seed)
+    : amount(amount), seed(seed), updates(0), cursor(0), current(0), block(), shader(shader), updateShader(updateShader),
+      texture(texture) {
+    this->init();
+}
+
+GpuParticleGenerator::~GpuParticleGenerator() {
+    for(unsigned int i = 0; i < 2; i++) {
+        GLState::DeleteVertexArray(this->updateVAOs[i]);
+        GLState::DeleteVertexArray(this->renderVAOs[i]);
+        GLState::DeleteBuffer(this->buffers[i]);
+    }
+    GLState::DeleteBuffer(this->quadVBO);
+    GLState::DeleteBuffer(this->UBO);
+}
+
+bool GpuParticleGenerator::Spawn(ParticleFeedbackSpawn spawn) {
+    if(this->block.SpawnCount == GPU_PARTICLE_SPAWNS || !this->amount)
+        return false;
+    spawn.Count = std::min(spawn.Count, this->amount);
+    spawn.First = this->cursor;
+    this->cursor = (this->cursor + spawn.Count) % this->amount;
+    this->block.Spawns[this->block.SpawnCount++] = spawn;
+    this->recentSpawns.push_back({ spawn.Life, spawn.Count });
+    return true;
+}
+
+void GpuParticleGenerator::Update(float dt) {
+    for(auto& spawn : this->recentSpawns)
+        spawn.first -= dt;
+    this->recentSpawns.erase(std::remove_if(this->recentSpawns.begin(), this->recentSpawns.end(),
+        [](const std::pair<float, unsigned int>& spawn) { return spawn.first <= 0.0f; }), this->recentSpawns.end());
+
+    // only the used part of the spawn array is uploaded, the rest of the block follows the array
+    this->block.Seed = this->seed + this->updates++ * 0x9E3779B9u;
+    this->block.DeltaTime = dt;
+    this->block.Capacity = this->amount;
+    GLState::BindBuffer(GL_UNIFORM_BUFFER, this->UBO);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, this->block.SpawnCount * sizeof(ParticleFeedbackSpawn), this->block.Spawns);
+    glBufferSubData(GL_UNIFORM_BUFFER, offsetof(ParticleSpawnBlock, SpawnCount),
+        sizeof(ParticleSpawnBlock) - offsetof(ParticleSpawnBlock, SpawnCount), &this->block.SpawnCount);
+    this->block.SpawnCount = 0;
+
+    // read the current state, capture the next one into the other buffer
+    unsigned int next = 1 - this->current;
+    this->updateShader.Use();
+    GLState::BindVertexArray(this->updateVAOs[this->current]);
+    GLState::BindBuffer(GL_TRANSFORM_FEEDBACK_BUFFER, this->buffers[next]);
+    glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, this->buffers[next]);
+    glEnable(GL_RASTERIZER_DISCARD);
+    glBeginTransformFeedback(GL_POINTS);
+    glDrawArrays(GL_POINTS, 0, this->amount);
+    glEndTransformFeedback();
+    glDisable(GL_RASTERIZER_DISCARD);
+    this->current = next;
+}
+
+unsigned int GpuParticleGenerator::Draw() {
+    if(!this->amount)
+        return 0;
+    // every particle is drawn, the update moved the dead ones out of view
+    TextureRegion& texture = ResourceManager::GetTexture(this->texture);
+    this->shader.Use();
+    this->shader.SetVector4f(UNIFORM_UV_RECT, texture.UV);
+    texture.Texture.Bind();
+    GLState::BindVertexArray(this->renderVAOs[this->current]);
+    glDrawArraysInstanced(GL_TRIANGLES, 0, 6, this->amount);
+    return 1;
+}
+
+void GpuParticleGenerator::Submit(RenderQueue& queue) {
+    // use additive blending to give it a 'glow' effect
+    uint64_t key = RenderQueue::MakeKey(LAYER_PARTICLES, BLEND_ADDITIVE, this->shader.ID, ResourceManager::GetTexture(this->texture).Texture.ID);
+    queue.Submit(key, this, [this]() { return this->Draw(); });
+}
+
+unsigned int GpuParticleGenerator::LiveCount() const {
+    unsigned int live = 0;
+    for(const auto& spawn : this->recentSpawns)
+        live += spawn.second;
+    return std::min(live, this->amount);
+}
+
+unsigned int GpuParticleGenerator::Capacity() const {
+    return this->amount;
+}
+
+void GpuParticleGenerator::init() {
+    float quad[] = {
+        0.0f, 1.0f, 0.0f, 1.0f,
+        1.0f, 0.0f, 1.0f, 0.0f,
+        0.0f, 0.0f, 0.0f, 0.0f,
+
+        0.0f, 1.0f, 0.0f, 1.0f,
+        1.0f, 1.0f, 1.0f, 1.0f,
+        1.0f, 0.0f, 1.0f, 0.0f
+    };
+    glGenBuffers(1, &this->quadVBO);
+    GLState::BindBuffer(GL_ARRAY_BUFFER, this->quadVBO);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(quad), quad, GL_STATIC_DRAW);
+
+    // all particles start dead
+    std::vector<GpuParticle> particles(this->amount, { glm::vec2(-1.0e6f), glm::vec2(0.0f), glm::vec4(0.0f), glm::vec2(0.0f) });
+    glGenBuffers(2, this->buffers);
+    glGenVertexArrays(2, this->updateVAOs);
+    glGenVertexArrays(2, this->renderVAOs);
+    for(unsigned int i = 0; i < 2; i++) {
+        GLState::BindBuffer(GL_ARRAY_BUFFER, this->buffers[i]);
+        glBufferData(GL_ARRAY_BUFFER, particles.size() * sizeof(GpuParticle), particles.data(), GL_DYNAMIC_COPY);
+
+        // update input <vec2 position, vec2 velocity, vec4 color, vec2 life>
+        GLState::BindVertexArray(this->updateVAOs[i]);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(GpuParticle), (void*)offsetof(GpuParticle, Position));
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(GpuParticle), (void*)offsetof(GpuParticle, Velocity));
+        glEnableVertexAttribArray(2);
+        glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, sizeof(GpuParticle), (void*)offsetof(GpuParticle, Color));
+        glEnableVertexAttribArray(3);
+        glVertexAttribPointer(3, 2, GL_FLOAT, GL_FALSE, sizeof(GpuParticle), (void*)offsetof(GpuParticle, Life));
+
+        // drawing: the same attributes as the CPU particles, <vec4 vertex> plus per instance <vec2 offset> and <vec4 color>
+        GLState::BindVertexArray(this->renderVAOs[i]);
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(GpuParticle), (void*)offsetof(GpuParticle, Position));
+        glVertexAttribDivisor(1, 1);
+        glEnableVertexAttribArray(2);
+        glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, sizeof(GpuParticle), (void*)offsetof(GpuParticle, Color));
+        glVertexAttribDivisor(2, 1);
+        GLState::BindBuffer(GL_ARRAY_BUFFER, this->quadVBO);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
+    }
+
+    glGenBuffers(1, &this->UBO);
+    GLState::BindBuffer(GL_UNIFORM_BUFFER, this->UBO);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(ParticleSpawnBlock), &this->block, GL_DYNAMIC_DRAW);
+    glBindBufferBase(GL_UNIFORM_BUFFER, PARTICLE_SPAWN_BINDING, this->UBO);
+    unsigned int index = glGetUniformBlockIndex(this->updateShader.ID, "SpawnData");
+    if(index != GL_INVALID_INDEX)
+        glUniformBlockBinding(this->updateShader.ID, index, PARTICLE_SPAWN_BINDING);
+}
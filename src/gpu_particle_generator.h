@@ -0,0 +1,88 @@
+#ifndef GPU_PARTICLE_GENERATOR_H
+#define GPU_PARTICLE_GENERATOR_H
+
+#include <cstdint>
+#include <vector>
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include "shader.h"
+#include "texture.h"
+#include "render_queue.h"
+
+// maximum number of spawns per update, the size of the spawn array in particle_update.vs
+const unsigned int GPU_PARTICLE_SPAWNS = 32;
+// binding point of the SpawnData uniform block (FRAME_UNIFORM_BINDING is 0)
+const unsigned int PARTICLE_SPAWN_BINDING = 1;
+
+// emitter parameters of a spawn, laid out as the std140 `Spawn` struct of particle_update.vs
+struct ParticleFeedbackSpawn {
+    glm::vec2 Position, Velocity;                // offset 0
+    glm::vec4 Color;                             // offset 16
+    float Spread, Speed, Inherit, ColorVariance; // offset 32, see ParticleEmitterConfig
+    float Life, Fade;                            // offset 48
+    unsigned int First, Count;                   // offset 56, set by GpuParticleGenerator::Spawn()
+};
+
+// contents of the `SpawnData` uniform block
+struct ParticleSpawnBlock {
+    ParticleFeedbackSpawn Spawns[GPU_PARTICLE_SPAWNS]; // offset 0
+    unsigned int SpawnCount;                           // offset 2048
+    unsigned int Seed;
+    float DeltaTime;
+    unsigned int Capacity;
+};
+
+// state of a single particle in the GPU buffers, matches the inputs of particle_update.vs
+struct GpuParticle {
+    glm::vec2 Position, Velocity;
+    glm::vec4 Color;
+    glm::vec2 Life; // <remaining life, alpha lost per second>
+};
+
+// GpuParticleGenerator keeps all particles in two GL buffers and updates them
+// on the GPU: a vertex shader reads one buffer and its outputs are captured
+// into the other by transform feedback, then the two swap roles. The CPU only
+// writes the parameters of the spawns into a small uniform block, so its cost
+// does not depend on the number of particles. Particles are spawned into the
+// buffer as a ring, a spawn replaces the oldest particles (there is no read
+// back to find the dead ones).
+class GpuParticleGenerator {
+public:
+    // shader draws the particles (particle.vs), updateShader is the transform feedback program
+    GpuParticleGenerator(Shader shader, Shader updateShader, TextureHandle texture, unsigned int amount, uint32_t seed = 1);
+    ~GpuParticleGenerator();
+    GpuParticleGenerator(const GpuParticleGenerator&) = delete;
+    GpuParticleGenerator& operator=(const GpuParticleGenerator&) = delete;
+    // queues count particles for the next update, returns false if GPU_PARTICLE_SPAWNS spawns are queued already
+    bool Spawn(ParticleFeedbackSpawn spawn);
+    // spawns the queued particles and advances all particles on the GPU
+    void Update(float dt);
+    // render all particles with a single instanced draw call, returns the number of draw calls issued
+    unsigned int Draw();
+    // queue the particles for the frame's render queue (drawn with additive blending)
+    void Submit(RenderQueue& queue);
+    // estimate of the live particles, from the lifetimes of the recent spawns
+    unsigned int LiveCount() const;
+    unsigned int Capacity() const;
+private:
+    unsigned int amount;
+    uint32_t seed;
+    unsigned int updates;
+    unsigned int cursor;  // ring position of the next spawn
+    unsigned int current; // index of the buffer holding the latest state
+    ParticleSpawnBlock block;
+    std::vector<std::pair<float, unsigned int>> recentSpawns; // <remaining life, count>
+    // render state
+    Shader shader, updateShader;
+    TextureHandle texture;
+    unsigned int buffers[2];
+    unsigned int updateVAOs[2]; // read the particle state of buffers[i]
+    unsigned int renderVAOs[2]; // quad mesh plus the state of buffers[i] as instance attributes
+    unsigned int quadVBO, UBO;
+    // creates the buffers and vertex arrays
+    void init();
+};
+
+#endif
@@ -3,19 +3,53 @@
 
 #include "game.h"
 #include "resource_manager.h"
+#include "gl_state.h"
+#include "offscreen_target.h"
 
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
+#include <string>
+
+// options of a headless run, the game renders into an offscreen framebuffer without
+// user input and reports its render throughput
+// usage: breakout --headless [--osmesa] [--frames N] [--seed N] [--threads N] [--gpu-particles] [--balls N] [--ball-collisions]
+//                  [--dump DIR] [--dump-every N]
+struct HeadlessOptions {
+    bool Enabled = false;
+    bool OSMesa = false;        // create the context through OSMesa, no display is needed at all
+    unsigned int Frames = 600;  // number of frames to simulate and render
+    unsigned int Seed = 0;      // random seed, so dumped frames can be compared against golden images
+    int Threads = -1;           // worker threads of the simulation, -1 keeps the game's default
+    bool GpuParticles = false;  // simulate the particles on the GPU
+    unsigned int Balls = 0;     // balls of the stress mode, also used by windowed runs
+    bool BallCollisions = false; // the stress mode balls collide with each other
+    std::string DumpDir;        // directory PNG frames are written to, empty writes nothing
+    unsigned int DumpEvery = 0; // write every n-th frame, 0 only writes the last frame
+};
 
 // GLFW callback function declarations
 void framebuffer_size_callback(GLFWwindow* window, int width, int height);
 void key_callback(GLFWwindow* window, int key, int scancode, int action, int mode);
 
+bool parseArguments(int argc, char** argv, HeadlessOptions& options);
+void runHeadless(const HeadlessOptions& options);
+
 const unsigned int SCREEN_WIDTH = 800;
 const unsigned int SCREEN_HEIGHT = 600;
 
 Game Breakout(SCREEN_WIDTH, SCREEN_HEIGHT);
 
 int main(int argc, char** argv) {
+    HeadlessOptions headless;
+    if(!parseArguments(argc, argv, headless))
+        return -1;
+
+    if(headless.OSMesa) {
+        // the null platform needs no window system, OSMesa renders with the CPU (llvmpipe)
+        glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_NULL);
+    }
     glfwInit();
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
@@ -26,8 +60,17 @@ int main(int argc, char** argv) {
 #endif
 
     glfwWindowHint(GLFW_RESIZABLE, false);
+    if(headless.Enabled)
+        glfwWindowHint(GLFW_VISIBLE, false);
+    if(headless.OSMesa)
+        glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_OSMESA_CONTEXT_API);
 
     GLFWwindow* window = glfwCreateWindow(SCREEN_WIDTH, SCREEN_HEIGHT, "Breakout", nullptr, nullptr);
+    if(!window) {
+        std::cout << "Failed to create GLFW window" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
     glfwMakeContextCurrent(window);
 
     // glad: load all opengl function pointers
@@ -41,8 +84,17 @@ int main(int argc, char** argv) {
 
     // OpenGL configuration
     glViewport(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT);
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    GLState::SetBlend(true);
+    GLState::BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    Breakout.StressBalls = headless.Balls;
+    Breakout.BallCollisions = headless.BallCollisions;
+    if(headless.Enabled) {
+        runHeadless(headless);
+        ResourceManager::Clear();
+        glfwTerminate();
+        return 0;
+    }
 
     // initialize game
     Breakout.Init();
@@ -58,11 +110,8 @@ int main(int argc, char** argv) {
         lastFrame = currentFrame;
         glfwPollEvents();
 
-        // manage user input
-        Breakout.ProcessInput(deltaTime);
-
-        // update game state
-        Breakout.Update(deltaTime);
+        // manage user input and update game state in fixed steps
+        Breakout.Tick(deltaTime);
 
         // render
         glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
@@ -100,4 +149,88 @@ void framebuffer_size_callback(GLFWwindow* window, int width, int height)
     // make sure the viewport matches the new window dimensions; note that width and 
     // height will be significantly larger than specified on retina displays.
     glViewport(0, 0, width, height);
-}
\ No newline at end of file
+}
+
+bool parseArguments(int argc, char** argv, HeadlessOptions& options) {
+    for(int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if(!strcmp(argv[i], "--headless"))
+            options.Enabled = true;
+        else if(!strcmp(argv[i], "--osmesa"))
+            options.Enabled = options.OSMesa = true;
+        else if(!strcmp(argv[i], "--frames") && hasValue)
+            options.Frames = strtoul(argv[++i], nullptr, 10);
+        else if(!strcmp(argv[i], "--seed") && hasValue)
+            options.Seed = strtoul(argv[++i], nullptr, 10);
+        else if(!strcmp(argv[i], "--threads") && hasValue)
+            options.Threads = atoi(argv[++i]);
+        else if(!strcmp(argv[i], "--gpu-particles"))
+            options.GpuParticles = true;
+        else if(!strcmp(argv[i], "--balls") && hasValue)
+            options.Balls = strtoul(argv[++i], nullptr, 10);
+        else if(!strcmp(argv[i], "--ball-collisions"))
+            options.BallCollisions = true;
+        else if(!strcmp(argv[i], "--dump") && hasValue)
+            options.DumpDir = argv[++i];
+        else if(!strcmp(argv[i], "--dump-every") && hasValue)
+            options.DumpEvery = strtoul(argv[++i], nullptr, 10);
+        else {
+            std::cout << "usage: " << argv[0]
+                << " [--headless] [--osmesa] [--frames N] [--seed N] [--threads N] [--gpu-particles] [--balls N] [--ball-collisions]"
+                << " [--dump DIR] [--dump-every N]" << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+void runHeadless(const HeadlessOptions& options) {
+    // the offscreen target replaces the window's framebuffer, the post processor renders into it
+    OffscreenTarget target(SCREEN_WIDTH, SCREEN_HEIGHT);
+    Breakout.Framebuffer = target.ID;
+    // the frames must not depend on the number of threads either
+    Breakout.Deterministic = true;
+    if(options.Threads >= 0)
+        Breakout.WorkerThreads = options.Threads;
+    Breakout.GpuParticles = options.GpuParticles;
+    Breakout.Init();
+
+    // fixed seed and time step, the same arguments always render the same frames
+    srand(options.Seed);
+    // 60 frames per second, a whole number of simulation steps each
+    const float deltaTime = 4.0f * SIMULATION_STEP;
+    // launch the ball so the run covers collisions, particles and power ups
+    Breakout.Keys[GLFW_KEY_SPACE] = true;
+
+    double renderTime = 0.0, updateTime = 0.0;
+    unsigned long long drawCalls = 0;
+    for(unsigned int frame = 0; frame < options.Frames; frame++) {
+        double update = glfwGetTime();
+        Breakout.Tick(deltaTime);
+        updateTime += glfwGetTime() - update;
+
+        GLState::BindFramebuffer(GL_FRAMEBUFFER, target.ID);
+        glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT);
+
+        double start = glfwGetTime();
+        Breakout.Render();
+        glFinish(); // wait for the GPU, so the time covers the whole frame
+        renderTime += glfwGetTime() - start;
+        drawCalls += Breakout.FrameStats.DrawCalls;
+
+        bool last = frame + 1 == options.Frames;
+        bool dump = options.DumpEvery ? frame % options.DumpEvery == 0 || last : last;
+        if(!options.DumpDir.empty() && dump) {
+            char name[32];
+            snprintf(name, sizeof(name), "/frame_%05u.png", frame);
+            target.SavePNG(options.DumpDir + name);
+        }
+    }
+
+    unsigned int frames = options.Frames ? options.Frames : 1;
+    std::cout << "GL " << glGetString(GL_VERSION) << ", " << glGetString(GL_RENDERER) << std::endl;
+    std::cout << options.Frames << " frames, " << renderTime * 1000.0 / frames << " ms/frame, "
+        << (renderTime > 0.0 ? options.Frames / renderTime : 0.0) << " frames/sec, "
+        << static_cast<double>(drawCalls) / frames << " draw calls/frame, " << updateTime * 1000.0 / frames << " ms/update" << std::endl;
+}
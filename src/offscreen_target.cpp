@@ -0,0 +1,129 @@
+#include "offscreen_target.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
+
+#include "gl_state.h"
+
+// largest block of an uncompressed deflate stream
+const unsigned int DEFLATE_STORED_BLOCK = 65535;
+
+OffscreenTarget::OffscreenTarget(unsigned int width, unsigned int height)
+    : Width(width), Height(height) {
+    glGenFramebuffers(1, &this->ID);
+    glGenRenderbuffers(1, &this->RBO);
+
+    GLState::BindFramebuffer(GL_FRAMEBUFFER, this->ID);
+    glBindRenderbuffer(GL_RENDERBUFFER, this->RBO);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, this->RBO);
+
+    if(glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        std::cout << "ERROR::OFFSCREEN_TARGET: Failed to initialize FBO" << std::endl;
+
+    GLState::BindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+OffscreenTarget::~OffscreenTarget() {
+    GLState::DeleteFramebuffer(this->ID);
+    glDeleteRenderbuffers(1, &this->RBO);
+}
+
+std::vector<unsigned char> OffscreenTarget::ReadPixels() {
+    std::vector<unsigned char> pixels(this->Width * this->Height * 4);
+    std::vector<unsigned char> flipped(pixels.size());
+    unsigned int stride = this->Width * 4;
+
+    GLState::BindFramebuffer(GL_READ_FRAMEBUFFER, this->ID);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, this->Width, this->Height, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+
+    // GL returns the bottom row first
+    for(unsigned int y = 0; y < this->Height; y++)
+        std::copy(&pixels[(this->Height - 1 - y) * stride], &pixels[(this->Height - y) * stride], &flipped[y * stride]);
+    return flipped;
+}
+
+// crc32 of the PNG chunks (polynomial 0xEDB88320)
+static uint32_t crc32(const unsigned char* data, size_t size, uint32_t crc = 0) {
+    static uint32_t table[256];
+    if(!table[1])
+        for(uint32_t i = 0; i < 256; i++) {
+            uint32_t c = i;
+            for(int k = 0; k < 8; k++)
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            table[i] = c;
+        }
+    crc = ~crc;
+    for(size_t i = 0; i < size; i++)
+        crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+static void putBigEndian(std::vector<unsigned char>& out, uint32_t value) {
+    out.push_back(value >> 24);
+    out.push_back(value >> 16);
+    out.push_back(value >> 8);
+    out.push_back(value);
+}
+
+static void writeChunk(FILE* file, const char* type, const std::vector<unsigned char>& data) {
+    std::vector<unsigned char> chunk;
+    putBigEndian(chunk, data.size());
+    chunk.insert(chunk.end(), type, type + 4);
+    chunk.insert(chunk.end(), data.begin(), data.end());
+    // the crc covers the type and the data, not the length
+    putBigEndian(chunk, crc32(&chunk[4], chunk.size() - 4));
+    fwrite(chunk.data(), 1, chunk.size(), file);
+}
+
+bool OffscreenTarget::SavePNG(const std::string& path) {
+    std::vector<unsigned char> pixels = this->ReadPixels();
+    unsigned int stride = this->Width * 4;
+
+    // scanlines with filter type 0 (none)
+    std::vector<unsigned char> raw;
+    raw.reserve((stride + 1) * this->Height);
+    for(unsigned int y = 0; y < this->Height; y++) {
+        raw.push_back(0);
+        raw.insert(raw.end(), &pixels[y * stride], &pixels[(y + 1) * stride]);
+    }
+
+    // zlib stream of uncompressed deflate blocks, golden images favour simplicity over size
+    std::vector<unsigned char> zlib = { 0x78, 0x01 };
+    uint32_t a = 1, b = 0; // adler32
+    for(size_t pos = 0; pos < raw.size(); pos += DEFLATE_STORED_BLOCK) {
+        unsigned int size = std::min<size_t>(DEFLATE_STORED_BLOCK, raw.size() - pos);
+        zlib.push_back(pos + size == raw.size() ? 1 : 0); // final block flag
+        zlib.push_back(size & 0xFF);
+        zlib.push_back(size >> 8);
+        zlib.push_back(~size & 0xFF);
+        zlib.push_back((~size >> 8) & 0xFF);
+        zlib.insert(zlib.end(), &raw[pos], &raw[pos] + size);
+        for(unsigned int i = 0; i < size; i++) {
+            a = (a + raw[pos + i]) % 65521;
+            b = (b + a) % 65521;
+        }
+    }
+    putBigEndian(zlib, (b << 16) | a);
+
+    std::vector<unsigned char> header;
+    putBigEndian(header, this->Width);
+    putBigEndian(header, this->Height);
+    header.insert(header.end(), { 8, 6, 0, 0, 0 }); // 8 bit RGBA, no interlacing
+
+    FILE* file = fopen(path.c_str(), "wb");
+    if(!file) {
+        std::cout << "ERROR::OFFSCREEN_TARGET: Failed to write " << path << std::endl;
+        return false;
+    }
+    const unsigned char signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    fwrite(signature, 1, sizeof(signature), file);
+    writeChunk(file, "IHDR", header);
+    writeChunk(file, "IDAT", zlib);
+    writeChunk(file, "IEND", {});
+    fclose(file);
+    return true;
+}
@@ -0,0 +1,27 @@
+#ifndef OFFSCREEN_TARGET_H
+#define OFFSCREEN_TARGET_H
+
+#include <string>
+#include <vector>
+
+#include <glad/glad.h>
+
+// OffscreenTarget is a framebuffer with a single RGBA8 color buffer that takes
+// the place of the window's default framebuffer when the game runs headless.
+// The rendered frame can be read back and saved as a PNG image.
+class OffscreenTarget {
+public:
+    unsigned int ID; // framebuffer object
+    unsigned int Width, Height;
+
+    OffscreenTarget(unsigned int width, unsigned int height);
+    ~OffscreenTarget();
+    // reads the color buffer, RGBA8 rows from top to bottom
+    std::vector<unsigned char> ReadPixels();
+    // writes the color buffer to a PNG file, returns false if the file could not be written
+    bool SavePNG(const std::string& path);
+private:
+    unsigned int RBO; // color buffer
+};
+
+#endif
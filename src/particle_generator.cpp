@@ -1,58 +1,196 @@
 #include "particle_generator.h"
+#include "gl_state.h"
+#include "stream_buffer.h"
+#include "resource_manager.h"
 
-ParticleGenerator::ParticleGenerator(Shader shader, Texture2D texture, unsigned int amount)
-    : shader(shader), texture(texture), amount(amount)
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+constexpr UniformName UNIFORM_UV_RECT("uvRect");
+
+
+ParticleGenerator::ParticleGenerator(Shader shader, TextureHandle texture, unsigned int amount)
+    : Overflow(PARTICLE_OVERFLOW_REPLACE), Counters(), amount(amount), live(0), livePerPriority(), replaceCursor(0),
+      shader(shader), texture(texture)
 {
     this->init();
 }
 
-void ParticleGenerator::Update(float dt, GameObject &object, unsigned int newParticles, glm::vec2 offset)
+bool ParticleGenerator::Spawn(const ParticleSpawn& particle)
+{
+    int index = this->allocateParticle();
+    if (index < 0)
+        return false;
+    this->Write(index, particle);
+    this->livePerPriority[particle.Priority]++;
+    return true;
+}
+
+void ParticleGenerator::Update(float dt)
+{
+    this->Simulate(dt, 0, this->live);
+    this->RemoveDead();
+}
+
+unsigned int ParticleGenerator::Allocate(unsigned int count, ParticlePriority priority)
+{
+    // the free particles are always right behind the live ones
+    unsigned int first = this->live;
+    this->live += count;
+    this->livePerPriority[priority] += count;
+    this->Counters.Spawned += count;
+    return first;
+}
+
+void ParticleGenerator::Write(unsigned int index, const ParticleSpawn& particle)
+{
+    ParticleArrays& p = this->particles;
+    p.PositionX[index] = particle.Position.x;
+    p.PositionY[index] = particle.Position.y;
+    p.VelocityX[index] = particle.Velocity.x;
+    p.VelocityY[index] = particle.Velocity.y;
+    p.ColorR[index] = particle.Color.r;
+    p.ColorG[index] = particle.Color.g;
+    p.ColorB[index] = particle.Color.b;
+    p.ColorA[index] = particle.Color.a;
+    p.Fade[index] = particle.Fade;
+    p.Life[index] = particle.Life;
+    p.Priority[index] = particle.Priority;
+}
+
+unsigned int ParticleGenerator::Cull(ParticlePriority below, unsigned int count)
+{
+    unsigned int culled = 0;
+    for (unsigned int priority = PARTICLE_PRIORITY_LOW; priority < below && culled < count; ++priority)
+    {
+        // walk backwards, the particle swapped into a removed slot was already checked
+        for (unsigned int i = this->live; i-- > 0 && culled < count && this->livePerPriority[priority];)
+        {
+            if (this->particles.Priority[i] == priority)
+            {
+                this->removeParticle(i);
+                culled++;
+            }
+        }
+    }
+    // removeParticle counts deaths, culled particles did not die of age
+    this->Counters.Died -= culled;
+    this->Counters.Culled += culled;
+    if (this->replaceCursor >= this->live)
+        this->replaceCursor = 0;
+    return culled;
+}
+
+unsigned int ParticleGenerator::LiveCount() const
+{
+    return this->live;
+}
+
+unsigned int ParticleGenerator::LiveCount(ParticlePriority priority) const
+{
+    return this->livePerPriority[priority];
+}
+
+unsigned int ParticleGenerator::Capacity() const
+{
+    return this->amount;
+}
+
+void ParticleGenerator::Simulate(float dt, unsigned int begin, unsigned int end)
 {
-    // add new particles 
-    for (unsigned int i = 0; i < newParticles; ++i)
+    ParticleArrays& p = this->particles;
+    // whole registers only, a register crossing end may hold particles another thread writes
+    unsigned int i = begin;
+
+#if defined(SIMD_AVX)
+    const __m256 vdt = _mm256_set1_ps(dt), zero = _mm256_setzero_ps();
+    for (; i + 8 <= end; i += 8)
+    {
+        // reduce life
+        __m256 life = _mm256_sub_ps(_mm256_load_ps(&p.Life[i]), vdt);
+        _mm256_store_ps(&p.Life[i], life);
+        __m256 alive = _mm256_cmp_ps(life, zero, _CMP_GT_OQ);
+        if (!_mm256_movemask_ps(alive))
+            continue;
+        // particles that are alive are updated, the others keep their state
+        __m256 x = _mm256_load_ps(&p.PositionX[i]), y = _mm256_load_ps(&p.PositionY[i]), a = _mm256_load_ps(&p.ColorA[i]);
+        x = _mm256_blendv_ps(x, _mm256_add_ps(x, _mm256_mul_ps(_mm256_load_ps(&p.VelocityX[i]), vdt)), alive);
+        y = _mm256_blendv_ps(y, _mm256_add_ps(y, _mm256_mul_ps(_mm256_load_ps(&p.VelocityY[i]), vdt)), alive);
+        a = _mm256_blendv_ps(a, _mm256_sub_ps(a, _mm256_mul_ps(_mm256_load_ps(&p.Fade[i]), vdt)), alive);
+        _mm256_store_ps(&p.PositionX[i], x);
+        _mm256_store_ps(&p.PositionY[i], y);
+        _mm256_store_ps(&p.ColorA[i], a);
+    }
+#elif defined(SIMD_SSE2)
+    const __m128 vdt = _mm_set1_ps(dt), zero = _mm_setzero_ps();
+    for (; i + 4 <= end; i += 4)
     {
-        int unusedParticle = this->firstUnusedParticle();
-        this->respawnParticle(this->particles[unusedParticle], object, offset);
+        // reduce life
+        __m128 life = _mm_sub_ps(_mm_load_ps(&p.Life[i]), vdt);
+        _mm_store_ps(&p.Life[i], life);
+        __m128 alive = _mm_cmpgt_ps(life, zero);
+        if (!_mm_movemask_ps(alive))
+            continue;
+        // particles that are alive are updated, the others keep their state (SSE2 has no blend, select with masks)
+        __m128 x = _mm_load_ps(&p.PositionX[i]), y = _mm_load_ps(&p.PositionY[i]), a = _mm_load_ps(&p.ColorA[i]);
+        __m128 dx = _mm_and_ps(alive, _mm_mul_ps(_mm_load_ps(&p.VelocityX[i]), vdt));
+        __m128 dy = _mm_and_ps(alive, _mm_mul_ps(_mm_load_ps(&p.VelocityY[i]), vdt));
+        __m128 da = _mm_and_ps(alive, _mm_mul_ps(_mm_load_ps(&p.Fade[i]), vdt));
+        _mm_store_ps(&p.PositionX[i], _mm_add_ps(x, dx));
+        _mm_store_ps(&p.PositionY[i], _mm_add_ps(y, dy));
+        _mm_store_ps(&p.ColorA[i], _mm_sub_ps(a, da));
     }
-    // update all particles
-    for (unsigned int i = 0; i < this->amount; ++i)
+#endif
+    for (; i < end; ++i)
     {
-        Particle &p = this->particles[i];
-        p.Life -= dt; // reduce life
-        if (p.Life > 0.0f)
+        p.Life[i] -= dt; // reduce life
+        if (p.Life[i] > 0.0f)
         {	// particle is alive, thus update
-            p.Position -= p.Velocity * dt; 
-            p.Color.a -= dt * 2.5f;
+            p.PositionX[i] += p.VelocityX[i] * dt;
+            p.PositionY[i] += p.VelocityY[i] * dt;
+            p.ColorA[i] -= p.Fade[i] * dt;
         }
     }
 }
 
 // render all particles
-void ParticleGenerator::Draw()
+unsigned int ParticleGenerator::Draw()
 {
-    // use additive blending to give it a 'glow' effect
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE);
+    // one instance per live particle, all of them are drawn with a single instanced call
+    this->instances.clear();
+    const ParticleArrays& p = this->particles;
+    for (unsigned int i = 0; i < this->live; ++i)
+        this->instances.push_back({ glm::vec2(p.PositionX[i], p.PositionY[i]), glm::vec4(p.ColorR[i], p.ColorG[i], p.ColorB[i], p.ColorA[i]) });
+    if (this->instances.empty())
+        return 0;
+    unsigned int offset = StreamBuffer::Write(this->instances.data(), this->instances.size() * sizeof(ParticleInstance), sizeof(ParticleInstance));
+    if (offset == STREAM_BUFFER_INVALID)
+        return 0;
+
+    TextureRegion& texture = ResourceManager::GetTexture(this->texture);
     this->shader.Use();
-    for (Particle particle : this->particles)
-    {
-        if (particle.Life > 0.0f)
-        {
-            this->shader.SetVector2f("offset", particle.Position);
-            this->shader.SetVector4f("color", particle.Color);
-            this->texture.Bind();
-            glBindVertexArray(this->VAO);
-            glDrawArrays(GL_TRIANGLES, 0, 6);
-            glBindVertexArray(0);
-        }
-    }
-    // don't forget to reset to default blending mode
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    this->shader.SetVector4f(UNIFORM_UV_RECT, texture.UV);
+    texture.Texture.Bind();
+    GLState::BindVertexArray(this->VAO);
+    // GL 3.3 has no base instance, point the instance attributes at this frame's data instead
+    GLState::BindBuffer(GL_ARRAY_BUFFER, StreamBuffer::ID);
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(ParticleInstance), (void*)(uintptr_t)(offset + offsetof(ParticleInstance, Offset)));
+    glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, sizeof(ParticleInstance), (void*)(uintptr_t)(offset + offsetof(ParticleInstance, Color)));
+    glDrawArraysInstanced(GL_TRIANGLES, 0, 6, this->instances.size());
+    return 1;
+}
+
+void ParticleGenerator::Submit(RenderQueue& queue)
+{
+    // use additive blending to give it a 'glow' effect
+    uint64_t key = RenderQueue::MakeKey(LAYER_PARTICLES, BLEND_ADDITIVE, this->shader.ID, ResourceManager::GetTexture(this->texture).Texture.ID);
+    queue.Submit(key, this, [this]() { return this->Draw(); });
 }
 
 void ParticleGenerator::init()
 {
     // set up mesh and attribute properties
-    unsigned int VBO;
     float particle_quad[] = {
         0.0f, 1.0f, 0.0f, 1.0f,
         1.0f, 0.0f, 1.0f, 0.0f,
@@ -63,50 +201,94 @@ void ParticleGenerator::init()
         1.0f, 0.0f, 1.0f, 0.0f
     }; 
     glGenVertexArrays(1, &this->VAO);
-    glGenBuffers(1, &VBO);
-    glBindVertexArray(this->VAO);
+    glGenBuffers(1, &this->quadVBO);
+    GLState::BindVertexArray(this->VAO);
     // fill mesh buffer
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    GLState::BindBuffer(GL_ARRAY_BUFFER, this->quadVBO);
     glBufferData(GL_ARRAY_BUFFER, sizeof(particle_quad), particle_quad, GL_STATIC_DRAW);
-    // set mesh attributes
+    // set mesh attributes <vec2 position, vec2 texCoords>
     glEnableVertexAttribArray(0);
     glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
-    glBindVertexArray(0);
+    // per instance attributes, streamed every frame: <vec2 offset> and <vec4 color>
+    GLState::BindBuffer(GL_ARRAY_BUFFER, StreamBuffer::ID);
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(ParticleInstance), (void*)offsetof(ParticleInstance, Offset));
+    glVertexAttribDivisor(1, 1);
+    glEnableVertexAttribArray(2);
+    glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, sizeof(ParticleInstance), (void*)offsetof(ParticleInstance, Color));
+    glVertexAttribDivisor(2, 1);
 
-    // create this->amount default particle instances
-    for (unsigned int i = 0; i < this->amount; ++i)
-        this->particles.push_back(Particle());
+    // create this->amount dead particles (plus the SIMD padding)
+    unsigned int count = SimdPadded(this->amount);
+    ParticleArrays& p = this->particles;
+    for (AlignedVector<float>* array : { &p.PositionX, &p.PositionY, &p.VelocityX, &p.VelocityY, &p.ColorR, &p.ColorG, &p.ColorB, &p.Fade })
+        array->assign(count, 0.0f);
+    p.ColorA.assign(count, 1.0f);
+    p.Life.assign(count, 0.0f);
+    p.Priority.assign(count, PARTICLE_PRIORITY_LOW);
 }
 
-// stores the index of the last particle used (for quick access to next dead particle)
-unsigned int lastUsedParticle = 0;
-unsigned int ParticleGenerator::firstUnusedParticle()
+int ParticleGenerator::allocateParticle()
 {
-    // first search from last used particle, this will usually return almost instantly
-    for (unsigned int i = lastUsedParticle; i < this->amount; ++i){
-        if (this->particles[i].Life <= 0.0f){
-            lastUsedParticle = i;
-            return i;
-        }
+    // the first dead particle is always right behind the live ones
+    if (this->live < this->amount)
+    {
+        this->Counters.Spawned++;
+        return this->live++;
+    }
+    if (this->amount == 0 || this->Overflow == PARTICLE_OVERFLOW_REFUSE)
+    {
+        this->Counters.Refused++;
+        return -1;
     }
-    // otherwise, do a linear search
-    for (unsigned int i = 0; i < lastUsedParticle; ++i){
-        if (this->particles[i].Life <= 0.0f){
-            lastUsedParticle = i;
-            return i;
+    this->Counters.Replaced++;
+    unsigned int index = this->replaceCursor;
+    this->replaceCursor = (this->replaceCursor + 1) % this->amount;
+    this->livePerPriority[this->particles.Priority[index]]--;
+    return index;
+}
+
+void ParticleGenerator::RemoveDead()
+{
+    ParticleArrays& p = this->particles;
+    // walk backwards, so the particle moved into a dead slot has already been checked and is alive
+    for (unsigned int group = SimdPadded(this->live); group > 0; group -= SIMD_PADDING)
+    {
+        unsigned int base = group - SIMD_PADDING;
+#if defined(SIMD_SSE2)
+        // skip groups without a dead particle (the padding behind the live range always counts as dead)
+        const __m128 zero = _mm_setzero_ps();
+        int dead = _mm_movemask_ps(_mm_cmple_ps(_mm_load_ps(&p.Life[base]), zero))
+            | _mm_movemask_ps(_mm_cmple_ps(_mm_load_ps(&p.Life[base + 4]), zero));
+        if (!dead)
+            continue;
+#endif
+        for (unsigned int i = std::min(group, this->live); i-- > base;)
+        {
+            if (p.Life[i] <= 0.0f)
+                this->removeParticle(i);
         }
     }
-    // all particles are taken, override the first one (note that if it repeatedly hits this case, more particles should be reserved)
-    lastUsedParticle = 0;
-    return 0;
+    if (this->replaceCursor >= this->live)
+        this->replaceCursor = 0;
 }
 
-void ParticleGenerator::respawnParticle(Particle &particle, GameObject &object, glm::vec2 offset)
+void ParticleGenerator::removeParticle(unsigned int index)
 {
-    float random = ((rand() % 100) - 50) / 10.0f;
-    float rColor = 0.5f + ((rand() % 100) / 100.0f);
-    particle.Position = object.Position + random + offset;
-    particle.Color = glm::vec4(rColor, rColor, rColor, 1.0f);
-    particle.Life = 1.0f;
-    particle.Velocity = object.Velocity * 0.1f;
-}
\ No newline at end of file
+    ParticleArrays& p = this->particles;
+    unsigned int last = --this->live;
+    this->livePerPriority[p.Priority[index]]--;
+    p.PositionX[index] = p.PositionX[last];
+    p.PositionY[index] = p.PositionY[last];
+    p.VelocityX[index] = p.VelocityX[last];
+    p.VelocityY[index] = p.VelocityY[last];
+    p.ColorR[index] = p.ColorR[last];
+    p.ColorG[index] = p.ColorG[last];
+    p.ColorB[index] = p.ColorB[last];
+    p.ColorA[index] = p.ColorA[last];
+    p.Fade[index] = p.Fade[last];
+    p.Life[index] = p.Life[last];
+    p.Priority[index] = p.Priority[last];
+    p.Life[last] = 0.0f;
+    this->Counters.Died++;
+}
@@ -15,45 +15,120 @@
 
 #include "shader.h"
 #include "texture.h"
-#include "game_object.h"
+#include "render_queue.h"
+#include "simd.h"
 
 
-// Represents a single particle and its state
-struct Particle {
+// priority of a particle, when the pool is full particles of lower priority are culled first
+enum ParticlePriority {
+    PARTICLE_PRIORITY_LOW,
+    PARTICLE_PRIORITY_NORMAL,
+    PARTICLE_PRIORITY_HIGH,
+    PARTICLE_PRIORITY_LEVELS // number of priorities
+};
+
+// The state of all particles of a generator, stored as a structure of arrays
+// so the update can process SIMD_WIDTH particles per instruction. Every array
+// is SIMD aligned and padded to a multiple of SIMD_PADDING. Live particles are
+// packed at the front of the arrays, everything behind them is dead (Life <= 0).
+struct ParticleArrays {
+    AlignedVector<float> PositionX, PositionY;
+    AlignedVector<float> VelocityX, VelocityY;
+    AlignedVector<float> ColorR, ColorG, ColorB, ColorA;
+    AlignedVector<float> Fade; // alpha lost per second
+    AlignedVector<float> Life;
+    std::vector<unsigned char> Priority; // ParticlePriority, not touched by the update kernel
+};
+
+// initial state of a spawned particle
+struct ParticleSpawn {
     glm::vec2 Position, Velocity;
     glm::vec4 Color;
-    float     Life;
+    float Life;     // seconds
+    float Fade;     // alpha lost per second
+    ParticlePriority Priority;
+};
 
-    Particle() : Position(0.0f), Velocity(0.0f), Color(1.0f), Life(0.0f) { }
+// per instance data of a live particle as streamed to the GPU
+struct ParticleInstance {
+    glm::vec2 Offset;
+    glm::vec4 Color;
+};
+
+// what happens to a spawn when all particles of a generator are alive
+enum ParticleOverflow {
+    PARTICLE_OVERFLOW_REPLACE, // replace live particles round robin, in a full pool these are roughly the oldest
+    PARTICLE_OVERFLOW_REFUSE   // drop the new particle
+};
+
+// spawn statistics of a generator since its creation
+struct ParticleCounters {
+    unsigned int Spawned;  // particles spawned into a free slot
+    unsigned int Replaced; // live particles overwritten by a spawn (PARTICLE_OVERFLOW_REPLACE)
+    unsigned int Refused;  // spawns dropped because the pool was full (PARTICLE_OVERFLOW_REFUSE)
+    unsigned int Culled;   // live particles killed by Cull() to make room
+    unsigned int Died;     // particles that reached the end of their life
 };
 
 
 // ParticleGenerator acts as a container for rendering a large number of 
 // particles by repeatedly spawning and updating particles and killing 
-// them after a given amount of time.
+// them after a given amount of time. It is the particle pool of the
+// ParticleSystem, which decides what is spawned.
 class ParticleGenerator
 {
 public:
-    // constructor
-    ParticleGenerator(Shader shader, Texture2D texture, unsigned int amount);
-    // update all particles
-    void Update(float dt, GameObject &object, unsigned int newParticles, glm::vec2 offset = glm::vec2(0.0f, 0.0f));
-    // render all particles
-    void Draw();
+    // overflow policy, may be changed at any time
+    ParticleOverflow Overflow;
+    ParticleCounters Counters;
+
+    // constructor, amount is the maximum number of live particles
+    ParticleGenerator(Shader shader, TextureHandle texture, unsigned int amount);
+    // spawns a particle in O(1), returns false if the overflow policy refused it
+    bool Spawn(const ParticleSpawn& particle);
+    // ages and moves all live particles and removes the dead ones
+    void Update(float dt);
+    // The parts of Update() and Spawn() for callers that split the work across threads:
+    // Allocate() makes count free particles live and returns the first of them (count must
+    // not exceed the free particles), each of them is then initialized with Write().
+    // Simulate() ages and moves the particles [begin, end), begin must be a multiple of
+    // SIMD_PADDING, and RemoveDead() compacts the pool.
+    // Write() and Simulate() may run concurrently on disjoint ranges, the others may not.
+    unsigned int Allocate(unsigned int count, ParticlePriority priority);
+    void Write(unsigned int index, const ParticleSpawn& particle);
+    void Simulate(float dt, unsigned int begin, unsigned int end);
+    void RemoveDead();
+    // kills up to count live particles with a priority below the given one (lowest priority
+    // first) and returns the number of particles killed
+    unsigned int Cull(ParticlePriority below, unsigned int count);
+    // render all live particles with a single instanced draw call (with the blend mode set by the caller), returns the number of draw calls issued
+    unsigned int Draw();
+    // queue the particles for the frame's render queue (drawn with additive blending)
+    void Submit(RenderQueue& queue);
+    // number of live particles, in total or of a single priority
+    unsigned int LiveCount() const;
+    unsigned int LiveCount(ParticlePriority priority) const;
+    // maximum number of live particles
+    unsigned int Capacity() const;
 private:
     // state
-    std::vector<Particle> particles;
+    ParticleArrays particles;
     unsigned int amount;
+    unsigned int live;           // particles [0, live) are alive
+    unsigned int livePerPriority[PARTICLE_PRIORITY_LEVELS];
+    unsigned int replaceCursor;  // next particle replaced on overflow
     // render state
     Shader shader;
-    Texture2D texture;
-    unsigned int VAO;
+    TextureHandle texture;
+    unsigned int VAO; // quad mesh plus per instance attributes from the StreamBuffer
+    unsigned int quadVBO;
+    std::vector<ParticleInstance> instances;
     // initializes buffer and vertex attributes
     void init();
-    // returns the first Particle index that's currently unused e.g. Life <= 0.0f or 0 if no particle is currently inactive
-    unsigned int firstUnusedParticle();
-    // respawns particle
-    void respawnParticle(Particle &particle, GameObject &object, glm::vec2 offset = glm::vec2(0.0f, 0.0f));
+    // returns the index a new particle is written to in O(1), or -1 if the overflow policy refuses it
+    int allocateParticle();
+    // swap-removes a single particle
+    void removeParticle(unsigned int index);
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,229 @@
+#include "particle_system.h"
+
+#include <algorithm>
+#include <cmath>
+
+// random numbers used per spawned particle: position jitter x / y, color, direction, speed
+const unsigned int RANDOMS_PER_PARTICLE = 5;
+const float TWO_PI = 6.28318530718f;
+// particles per job, large enough to make a job worth the hand over to another thread
+const unsigned int PARTICLE_UPDATE_CHUNK = 8192; // a multiple of SIMD_PADDING
+const unsigned int PARTICLE_SPAWN_CHUNK = 1024;
+
+// seed of a random stream, mixes its inputs so neighbouring streams are unrelated (murmur3 finalizer)
+static uint32_t streamSeed(uint32_t seed, uint32_t update, uint32_t stream) {
+    uint32_t h = seed ^ (update * 0x9E3779B9u) ^ (stream * 0x7FEB352Du);
+    h = (h ^ (h >> 16)) * 0x85EBCA6Bu;
+    h = (h ^ (h >> 13)) * 0xC2B2AE35u;
+    return h ^ (h >> 16);
+}
+
+ParticleSystem::ParticleSystem(Shader shader, TextureHandle texture, unsigned int budget, uint32_t seed)
+    : Stats(), Deterministic(false), pool(new ParticleGenerator(shader, texture, budget)), gpu(nullptr), seed(seed), updates(0), workers(nullptr),
+      dt(0.0f), simulated(0) {
+    // the system decides what gets dropped, the pool must never replace a particle on its own
+    this->pool->Overflow = PARTICLE_OVERFLOW_REFUSE;
+}
+
+ParticleSystem::ParticleSystem(Shader shader, Shader updateShader, TextureHandle texture, unsigned int budget, uint32_t seed)
+    : Stats(), Deterministic(true), pool(nullptr), gpu(new GpuParticleGenerator(shader, updateShader, texture, budget, seed)),
+      seed(seed), updates(0), workers(nullptr), dt(0.0f), simulated(0) {
+}
+
+ParticleSystem::~ParticleSystem() {
+    delete this->pool;
+    delete this->gpu;
+}
+
+unsigned int ParticleSystem::AddEmitter(const ParticleEmitterConfig& config) {
+    this->emitters.push_back({ config, glm::vec2(0.0f), glm::vec2(0.0f), false, 0.0f });
+    return this->emitters.size() - 1;
+}
+
+void ParticleSystem::SetEmitter(unsigned int emitter, glm::vec2 position, glm::vec2 velocity, bool active) {
+    Emitter& e = this->emitters[emitter];
+    e.Position = position;
+    e.Velocity = velocity;
+    e.Active = active;
+}
+
+void ParticleSystem::Burst(unsigned int emitter, glm::vec2 position) {
+    this->Burst(emitter, position, this->emitters[emitter].Config.Color);
+}
+
+void ParticleSystem::Burst(unsigned int emitter, glm::vec2 position, glm::vec4 color) {
+    unsigned int count = this->emitters[emitter].Config.BurstCount;
+    if(count)
+        this->requests.push_back({ emitter, count, position, glm::vec2(0.0f), color });
+}
+
+void ParticleSystem::Update(float dt) {
+    this->BeginUpdate(dt, nullptr);
+    this->EndUpdate();
+}
+
+void ParticleSystem::BeginUpdate(float dt, WorkerPool* workers) {
+    this->dt = dt;
+    if(this->gpu) {
+        // nothing for the workers to do, the GPU works asynchronously anyway
+        this->grantRequestsGpu();
+        this->gpu->Update(dt);
+        return;
+    }
+    this->workers = workers;
+    // all spawns are decided here, the jobs only write the particles they were given
+    this->grantRequests();
+
+    unsigned int threads = (workers ? workers->Threads() : 0) + 1;
+    if(this->streams.size() != threads) {
+        this->streams.resize(threads);
+        this->randoms.resize(threads);
+        for(unsigned int i = 0; i < threads; i++)
+            this->streams[i].Seed(streamSeed(this->seed, 0, i));
+    }
+
+    // aging the live particles and writing the new ones touch disjoint ranges, all jobs run at once
+    unsigned int updateJobs = (this->simulated + PARTICLE_UPDATE_CHUNK - 1) / PARTICLE_UPDATE_CHUNK;
+    unsigned int jobs = updateJobs + this->chunks.size();
+    if(workers)
+        workers->Dispatch(jobs, [this](unsigned int job, unsigned int thread) { this->runJob(job, thread); });
+    else
+        for(unsigned int i = 0; i < jobs; i++)
+            this->runJob(i, 0);
+}
+
+void ParticleSystem::EndUpdate() {
+    if(this->workers)
+        this->workers->Wait();
+    this->workers = nullptr;
+    if(this->pool)
+        this->pool->RemoveDead();
+    this->updates++;
+}
+
+void ParticleSystem::Submit(RenderQueue& queue) {
+    if(this->gpu)
+        this->gpu->Submit(queue);
+    else
+        this->pool->Submit(queue);
+}
+
+void ParticleSystem::ResetStats() {
+    this->Stats = ParticleStats();
+}
+
+unsigned int ParticleSystem::LiveCount() const {
+    return this->gpu ? this->gpu->LiveCount() : this->pool->LiveCount();
+}
+
+void ParticleSystem::collectRequests() {
+    // continuous emitters spawn whole particles, the remainder is carried over
+    for(unsigned int i = 0; i < this->emitters.size(); i++) {
+        Emitter& e = this->emitters[i];
+        if(!e.Active) {
+            e.Accumulator = 0.0f;
+            continue;
+        }
+        e.Accumulator += e.Config.SpawnRate * this->dt;
+        unsigned int count = static_cast<unsigned int>(e.Accumulator);
+        e.Accumulator -= count;
+        if(count)
+            this->requests.push_back({ i, count, e.Position, e.Velocity, e.Config.Color });
+    }
+
+    // grant the budget to the most important requests first, in emission order within a priority
+    std::stable_sort(this->requests.begin(), this->requests.end(), [this](const Request& a, const Request& b) {
+        return this->emitters[a.Emitter].Config.Priority > this->emitters[b.Emitter].Config.Priority;
+    });
+}
+
+void ParticleSystem::grantRequests() {
+    this->collectRequests();
+    this->chunks.clear();
+
+    unsigned int available = this->pool->Capacity() - this->pool->LiveCount();
+    for(Request& request : this->requests) {
+        if(request.Count > available) {
+            unsigned int culled = this->pool->Cull(this->emitters[request.Emitter].Config.Priority, request.Count - available);
+            this->Stats.Culled += culled;
+            available += culled;
+        }
+        unsigned int count = std::min(request.Count, available);
+        available -= count;
+        this->Stats.Requested += request.Count;
+        this->Stats.Refused += request.Count - count;
+        this->Stats.Spawned += count;
+        request.Count = count;
+    }
+    this->simulated = this->pool->LiveCount();
+
+    // culling swaps particles around, so the particles are allocated once all culling is done
+    for(const Request& request : this->requests) {
+        if(!request.Count)
+            continue;
+        const ParticleEmitterConfig& config = this->emitters[request.Emitter].Config;
+        unsigned int first = this->pool->Allocate(request.Count, config.Priority);
+        for(unsigned int offset = 0; offset < request.Count; offset += PARTICLE_SPAWN_CHUNK)
+            this->chunks.push_back({ config, request.Position, request.Velocity, request.Color,
+                first + offset, std::min(PARTICLE_SPAWN_CHUNK, request.Count - offset) });
+    }
+    this->requests.clear();
+}
+
+void ParticleSystem::grantRequestsGpu() {
+    this->collectRequests();
+
+    // a single update can not spawn more particles than the ring holds, nor use more than its spawn slots
+    unsigned int available = this->gpu->Capacity();
+    for(const Request& request : this->requests) {
+        const ParticleEmitterConfig& config = this->emitters[request.Emitter].Config;
+        unsigned int count = std::min(request.Count, available);
+        ParticleFeedbackSpawn spawn = { request.Position, request.Velocity, request.Color,
+            config.Spread, config.Speed, config.Inherit, config.ColorVariance, config.Lifetime, config.Fade, 0, count };
+        if(count && !this->gpu->Spawn(spawn))
+            count = 0;
+        available -= count;
+        this->Stats.Requested += request.Count;
+        this->Stats.Refused += request.Count - count;
+        this->Stats.Spawned += count;
+    }
+    this->requests.clear();
+}
+
+void ParticleSystem::runJob(unsigned int job, unsigned int thread) {
+    unsigned int updateJobs = (this->simulated + PARTICLE_UPDATE_CHUNK - 1) / PARTICLE_UPDATE_CHUNK;
+    if(job < updateJobs) {
+        unsigned int begin = job * PARTICLE_UPDATE_CHUNK;
+        this->pool->Simulate(this->dt, begin, std::min(begin + PARTICLE_UPDATE_CHUNK, this->simulated));
+        return;
+    }
+    unsigned int chunk = job - updateJobs;
+    if(this->Deterministic) {
+        SimdRandom random(streamSeed(this->seed, this->updates, chunk));
+        this->spawn(this->chunks[chunk], random, this->randoms[thread]);
+    } else {
+        this->spawn(this->chunks[chunk], this->streams[thread], this->randoms[thread]);
+    }
+}
+
+void ParticleSystem::spawn(const SpawnChunk& chunk, SimdRandom& random, std::vector<float>& randoms) {
+    const ParticleEmitterConfig& config = chunk.Config;
+    randoms.resize(chunk.Count * RANDOMS_PER_PARTICLE);
+    random.Uniform(randoms.data(), randoms.size());
+
+    ParticleSpawn particle;
+    particle.Life = config.Lifetime;
+    particle.Fade = config.Fade;
+    particle.Priority = config.Priority;
+    for(unsigned int i = 0; i < chunk.Count; i++) {
+        const float* r = &randoms[i * RANDOMS_PER_PARTICLE];
+        glm::vec2 jitter = (glm::vec2(r[0], r[1]) * 2.0f - 1.0f) * config.Spread;
+        float shade = 1.0f + (r[2] * 2.0f - 1.0f) * config.ColorVariance;
+        float angle = r[3] * TWO_PI, speed = r[4] * config.Speed;
+
+        particle.Position = chunk.Position + jitter;
+        particle.Velocity = chunk.Velocity * config.Inherit + glm::vec2(std::cos(angle), std::sin(angle)) * speed;
+        particle.Color = glm::vec4(glm::vec3(chunk.Color) * shade, chunk.Color.a);
+        this->pool->Write(chunk.First + i, particle);
+    }
+}
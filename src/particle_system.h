@@ -0,0 +1,132 @@
+#ifndef PARTICLE_SYSTEM_H
+#define PARTICLE_SYSTEM_H
+
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "particle_generator.h"
+#include "gpu_particle_generator.h"
+#include "render_queue.h"
+#include "simd.h"
+#include "worker_pool.h"
+
+// settings of a particle emitter
+struct ParticleEmitterConfig {
+    float SpawnRate;         // particles per second while the emitter is active
+    unsigned int BurstCount; // particles per Burst() call
+    float Lifetime;          // seconds
+    float Fade;              // alpha lost per second
+    ParticlePriority Priority;
+    glm::vec4 Color;
+    float ColorVariance;     // the color is scaled by a random factor in [1 - variance, 1 + variance]
+    float Spread;            // spawn positions are jittered by up to this many pixels
+    float Speed;             // particles fly off in random directions with a speed up to this
+    float Inherit;           // fraction of the emitter velocity given to its particles
+};
+
+// spawns since the last ResetStats()
+struct ParticleStats {
+    unsigned int Requested; // particles the emitters asked for
+    unsigned int Spawned;
+    unsigned int Refused;   // requests that did not fit into the budget
+    unsigned int Culled;    // live particles killed for requests of higher priority
+};
+
+// ParticleSystem runs any number of emitters on one shared pool of particles.
+// Emitters only queue spawn requests, Update() grants them by priority within
+// the global budget and then ages all particles of all emitters in one pass.
+// When the budget is exhausted, live particles of lower priority are culled
+// to make room and requests of the lowest priority are refused, so heavy
+// effects cost a bounded amount of work instead of frame time.
+// The update can run in chunks on a WorkerPool while the caller does other
+// work between BeginUpdate() and EndUpdate().
+// With the GPU backend the particles live in a GpuParticleGenerator instead.
+// Requests are still granted by priority, but as the CPU does not know which
+// particles are alive a spawn replaces the oldest particles, whatever their priority.
+class ParticleSystem {
+public:
+    ParticleStats Stats;
+    // every spawn chunk draws from its own random stream seeded by the chunk index, so
+    // the particles are the same for any number of threads (otherwise every thread has
+    // one stream and the result depends on which thread ran which chunk)
+    bool Deterministic;
+
+    // budget is the maximum number of live particles of all emitters together
+    ParticleSystem(Shader shader, TextureHandle texture, unsigned int budget, uint32_t seed = 1);
+    // GPU backend, the particles are updated by the transform feedback program updateShader
+    ParticleSystem(Shader shader, Shader updateShader, TextureHandle texture, unsigned int budget, uint32_t seed = 1);
+    ~ParticleSystem();
+    ParticleSystem(const ParticleSystem&) = delete;
+    ParticleSystem& operator=(const ParticleSystem&) = delete;
+    // adds an emitter and returns its id
+    unsigned int AddEmitter(const ParticleEmitterConfig& config);
+    // moves a continuous emitter, it spawns SpawnRate particles per second while active
+    void SetEmitter(unsigned int emitter, glm::vec2 position, glm::vec2 velocity, bool active);
+    // queues a burst of the emitter's BurstCount particles at a position, optionally with a different color
+    void Burst(unsigned int emitter, glm::vec2 position);
+    void Burst(unsigned int emitter, glm::vec2 position, glm::vec4 color);
+    // spawns the queued particles and updates all live particles
+    void Update(float dt);
+    // starts Update() on the workers (nullptr runs it right away), until EndUpdate() returns
+    // only SetEmitter() and Burst() may be called, their particles are spawned by the next update
+    void BeginUpdate(float dt, WorkerPool* workers);
+    // waits for the workers and removes the particles that died
+    void EndUpdate();
+    // queue the particles of all emitters for the frame's render queue
+    void Submit(RenderQueue& queue);
+    unsigned int LiveCount() const;
+    // zeroes Stats, the game does it once per rendered frame so they add up all steps of the frame
+    void ResetStats();
+private:
+    // a continuous emitter and its state
+    struct Emitter {
+        ParticleEmitterConfig Config;
+        glm::vec2 Position, Velocity;
+        bool Active;
+        float Accumulator; // fractional particles carried over to the next update
+    };
+    // particles an emitter wants to spawn this update
+    struct Request {
+        unsigned int Emitter;
+        unsigned int Count;
+        glm::vec2 Position, Velocity;
+        glm::vec4 Color;
+    };
+    // a part of a granted request, written to the particles [First, First + Count) by a job
+    struct SpawnChunk {
+        ParticleEmitterConfig Config; // a copy, the emitters may change while the job runs
+        glm::vec2 Position, Velocity;
+        glm::vec4 Color;
+        unsigned int First, Count;
+    };
+
+    ParticleGenerator* pool;   // nullptr with the GPU backend
+    GpuParticleGenerator* gpu; // nullptr with the CPU backend
+    uint32_t seed;
+    unsigned int updates; // number of updates so far, part of the deterministic stream seeds
+    std::vector<Emitter> emitters;
+    std::vector<Request> requests;
+    // work of the running update
+    WorkerPool* workers;
+    float dt;
+    unsigned int simulated; // particles [0, simulated) were alive before the spawns
+    std::vector<SpawnChunk> chunks;
+    // per thread state
+    std::vector<SimdRandom> streams;
+    std::vector<std::vector<float>> randoms;
+
+    // grants the queued requests and splits them into chunks
+    void grantRequests();
+    // grants the queued requests to the GPU generator
+    void grantRequestsGpu();
+    // adds the particles of the continuous emitters to the requests and sorts them by priority
+    void collectRequests();
+    // runs a single job of the update
+    void runJob(unsigned int job, unsigned int thread);
+    // writes the particles of a chunk
+    void spawn(const SpawnChunk& chunk, SimdRandom& random, std::vector<float>& randoms);
+};
+
+#endif
@@ -2,15 +2,17 @@
 
 #include <iostream>
 
+#include "gl_state.h"
+
 PostProcessor::PostProcessor(Shader shader, unsigned int width, unsigned int height)
-    : PostProcessingShader(shader), Texture(), Width(width), Height(height), Confuse(false), Chaos(false), Shake(false), Grayscale(false) {
+    : PostProcessingShader(shader), Texture(), Width(width), Height(height), Target(0), Confuse(false), Chaos(false), Shake(false), Grayscale(false) {
     glGenFramebuffers(1, &this->MSFBO);
     glGenFramebuffers(1, &this->FBO);
     glGenRenderbuffers(1, &this->RBO);
 
     // initialize rbo storage with a MS color buffer (don't need a depth/stencil buffer)
     // bind MS FBO
-    glBindFramebuffer(GL_FRAMEBUFFER, this->MSFBO);
+    GLState::BindFramebuffer(GL_FRAMEBUFFER, this->MSFBO);
     glBindRenderbuffer(GL_RENDERBUFFER, this->RBO);
 
     // MSFBO: for anti aliasing
@@ -21,7 +23,7 @@ PostProcessor::PostProcessor(Shader shader, unsigned int width, unsigned int hei
         std::cout << "ERROR::POSTPROCESSOR: Failed to initialize MSFBO" << std::endl;
 
     // Post processing effects
-    glBindFramebuffer(GL_FRAMEBUFFER, this->FBO);
+    GLState::BindFramebuffer(GL_FRAMEBUFFER, this->FBO);
     this->Texture.Generate(width, height, NULL);
 
     // Use `this->Texture` as color attachment for `this->FBO`
@@ -31,7 +33,7 @@ PostProcessor::PostProcessor(Shader shader, unsigned int width, unsigned int hei
         std::cout << "ERROR::POSTPROCESSOR: Failed to initialize FBO" << std::endl;
 
     // Setup screen rendering data
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    GLState::BindFramebuffer(GL_FRAMEBUFFER, 0);
 
     this->initRenderData();
     this->PostProcessingShader.SetInteger("scene", 0, true);
@@ -50,56 +52,49 @@ PostProcessor::PostProcessor(Shader shader, unsigned int width, unsigned int hei
     };
 
     // highlight edges
-    glUniform2fv(glGetUniformLocation(this->PostProcessingShader.ID, "offsets"), 9, (float*)offsets);
+    glUniform2fv(this->PostProcessingShader.GetUniform("offsets"), 9, (float*)offsets);
     int edge_kernel[9] = {
         -1, -1, -1,
         -1,  8, -1,
         -1, -1, -1
     };
     
-    glUniform1iv(glGetUniformLocation(this->PostProcessingShader.ID, "edge_kernel"), 9, edge_kernel);
+    glUniform1iv(this->PostProcessingShader.GetUniform("edge_kernel"), 9, edge_kernel);
     float blur_kernel[9] = {
         1.0f / 16.0f, 2.0f / 16.0f, 1.0f / 16.0f,
         2.0f / 16.0f, 4.0f / 16.0f, 2.0f / 16.0f,
         1.0f / 16.0f, 2.0f / 16.0f, 1.0f / 16.0f
     };
     
-    glUniform1fv(glGetUniformLocation(this->PostProcessingShader.ID, "blur_kernel"), 9, blur_kernel);
+    glUniform1fv(this->PostProcessingShader.GetUniform("blur_kernel"), 9, blur_kernel);
 }
 
 void PostProcessor::BeginRender() {
     // render scene to MS FBO
-    glBindFramebuffer(GL_FRAMEBUFFER, this->MSFBO);
+    GLState::BindFramebuffer(GL_FRAMEBUFFER, this->MSFBO);
     glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
     glClear(GL_COLOR_BUFFER_BIT);
 }
 
 void PostProcessor::EndRender() {
     // copy MS FBO to FBO (only color buffer)
-    glBindFramebuffer(GL_READ_FRAMEBUFFER, this->MSFBO);
-    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, this->FBO);
+    GLState::BindFramebuffer(GL_READ_FRAMEBUFFER, this->MSFBO);
+    GLState::BindFramebuffer(GL_DRAW_FRAMEBUFFER, this->FBO);
     
     // masks for blit:  The bitwise OR of the flags indicating which buffers are to be copied. The allowed flags are GL_COLOR_BUFFER_BIT, GL_DEPTH_BUFFER_BIT and GL_STENCIL_BUFFER_BIT. 
     glBlitFramebuffer(0, 0, this->Width, this->Height, 0, 0, this->Width, this->Height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
-    // binds both READ and WRITE framebuffer to default framebuffer
-    glBindFramebuffer(GL_FRAMEBUFFER, 0); 
+    // binds both READ and WRITE framebuffer to the target (the default framebuffer unless running headless)
+    GLState::BindFramebuffer(GL_FRAMEBUFFER, this->Target);
 }
 
-void PostProcessor::Render(float time) {
-    // set uniforms / options
+void PostProcessor::Render() {
     this->PostProcessingShader.Use();
-    this->PostProcessingShader.SetFloat("time", time);
-    this->PostProcessingShader.SetInteger("confuse", this->Confuse);
-    this->PostProcessingShader.SetInteger("chaos", this->Chaos);
-    this->PostProcessingShader.SetInteger("shake", this->Shake);
-    this->PostProcessingShader.SetInteger("grayscale", this->Grayscale);
 
     // render screen quad with the color texture
-    glActiveTexture(GL_TEXTURE0);
+    GLState::ActiveTexture(0);
     this->Texture.Bind(); // use the color attachment of `this->FBO`
-    glBindVertexArray(this->VAO);
+    GLState::BindVertexArray(this->VAO);
     glDrawArrays(GL_TRIANGLES, 0, 6);
-    glBindVertexArray(0);
 }
 
 void PostProcessor::initRenderData() {
@@ -119,12 +114,10 @@ void PostProcessor::initRenderData() {
     glGenVertexArrays(1, &this->VAO);
     glGenBuffers(1, &VBO);
 
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    GLState::BindBuffer(GL_ARRAY_BUFFER, VBO);
     glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
 
-    glBindVertexArray(this->VAO);
+    GLState::BindVertexArray(this->VAO);
     glEnableVertexAttribArray(0);
     glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
 }
\ No newline at end of file
@@ -19,6 +19,8 @@ public:
     Shader PostProcessingShader;
     Texture2D Texture;
     unsigned int Width, Height;
+    // framebuffer the processed scene is rendered to, 0 is the window
+    unsigned int Target;
 
     bool Confuse, Chaos, Shake, Grayscale;
 
@@ -31,7 +33,8 @@ public:
     void EndRender();
     
     // renders the PostProcessor texture quad (as a screen-encompassing large sprite)
-    void Render(float time);
+    // time and the effect flags are read from the per frame uniform block
+    void Render();
 private:
     unsigned int MSFBO; // multisampled fbo
     unsigned int FBO; // used for blitting MS color-buffer to texture
@@ -0,0 +1,136 @@
+#include "power_up_pool.h"
+
+#include <algorithm>
+
+#include "resource_manager.h"
+
+PowerUpPool::PowerUpPool() : removedCount(0), maxWidth(0.0f) {}
+
+unsigned int PowerUpPool::Size() const {
+    return this->PositionX.size();
+}
+
+void PowerUpPool::Add(const PowerUp& powerUp) {
+    PowerUpInterval interval = { powerUp.Position.x, powerUp.Position.x + powerUp.Size.x, this->Size() };
+    this->intervals.push_back(interval);
+    this->maxWidth = std::max(this->maxWidth, interval.Max - interval.Min);
+    this->PositionX.push_back(powerUp.Position.x);
+    this->PositionY.push_back(powerUp.Position.y);
+    this->Items.push_back(powerUp);
+    this->removed.push_back(0);
+}
+
+void PowerUpPool::Clear() {
+    this->PositionX.clear();
+    this->PositionY.clear();
+    this->Items.clear();
+    this->removed.clear();
+    this->removedCount = 0;
+    this->intervals.clear();
+    this->maxWidth = 0.0f;
+}
+
+void PowerUpPool::Fall(float dt) {
+    // all power ups fall at the same speed
+    float fall = VELOCITY.y * dt;
+    float* y = this->PositionY.data();
+    for(unsigned int i = 0; i < this->Size(); i++)
+        y[i] += fall;
+}
+
+void PowerUpPool::Remove(unsigned int index) {
+    this->removedCount += !this->removed[index];
+    this->removed[index] = 1;
+}
+
+bool PowerUpPool::Removed(unsigned int index) const {
+    return this->removed[index];
+}
+
+void PowerUpPool::RemoveBelow(float y) {
+    const float* py = this->PositionY.data();
+    unsigned char* flags = this->removed.data();
+    unsigned int count = 0;
+    for(unsigned int i = 0; i < this->Size(); i++) {
+        flags[i] |= py[i] >= y;
+        count += flags[i];
+    }
+    this->removedCount = count;
+}
+
+void PowerUpPool::Overlapping(glm::vec2 min, glm::vec2 max, std::vector<unsigned int>& out) {
+    out.clear();
+    // insertion sort, only the power ups added since the last query are out of place
+    for(unsigned int i = 1; i < this->intervals.size(); i++) {
+        PowerUpInterval interval = this->intervals[i];
+        unsigned int j = i;
+        for(; j > 0 && this->intervals[j - 1].Min > interval.Min; j--)
+            this->intervals[j] = this->intervals[j - 1];
+        this->intervals[j] = interval;
+    }
+
+    // the intervals reaching min.x start at most the widest interval before it
+    float first = min.x - this->maxWidth;
+    auto it = std::lower_bound(this->intervals.begin(), this->intervals.end(), first,
+        [](const PowerUpInterval& interval, float x) { return interval.Min < x; });
+    for(; it != this->intervals.end() && it->Min <= max.x; ++it) {
+        unsigned int i = it->Index;
+        if(it->Max >= min.x && !this->removed[i] && this->PositionY[i] + this->Items[i].Size.y >= min.y && this->PositionY[i] <= max.y)
+            out.push_back(i);
+    }
+    std::sort(out.begin(), out.end());
+}
+
+void PowerUpPool::Compact() {
+    if(!this->removedCount)
+        return;
+
+    // move the kept power ups down, remembering where each one went
+    this->moved.resize(this->Size());
+    unsigned int kept = 0;
+    for(unsigned int i = 0; i < this->Size(); i++) {
+        this->moved[i] = kept;
+        if(this->removed[i])
+            continue;
+        this->PositionX[kept] = this->PositionX[i];
+        this->PositionY[kept] = this->PositionY[i];
+        if(kept != i)
+            this->Items[kept] = std::move(this->Items[i]);
+        kept++;
+    }
+
+    // the intervals of the kept power ups stay sorted
+    unsigned int intervalsKept = 0;
+    this->maxWidth = 0.0f;
+    for(PowerUpInterval interval : this->intervals)
+        if(!this->removed[interval.Index]) {
+            interval.Index = this->moved[interval.Index];
+            this->intervals[intervalsKept++] = interval;
+            this->maxWidth = std::max(this->maxWidth, interval.Max - interval.Min);
+        }
+
+    this->PositionX.resize(kept);
+    this->PositionY.resize(kept);
+    this->Items.erase(this->Items.begin() + kept, this->Items.end());
+    this->intervals.resize(intervalsKept);
+    this->removed.assign(kept, 0);
+    this->removedCount = 0;
+}
+
+PowerUp PowerUpPool::Get(unsigned int index) const {
+    PowerUp powerUp = this->Items[index];
+    powerUp.Position = powerUp.PreviousPosition = glm::vec2(this->PositionX[index], this->PositionY[index]);
+    return powerUp;
+}
+
+void PowerUpPool::Submit(RenderQueue& queue, float behind) {
+    // the power ups fall in a straight line, so where they were is known without storing it
+    float back = VELOCITY.y * behind;
+    for(unsigned int i = 0; i < this->Size(); i++) {
+        if(this->removed[i])
+            continue;
+        const PowerUp& powerUp = this->Items[i];
+        queue.SubmitSprite(LAYER_OBJECTS, &powerUp, ResourceManager::GetTexture(powerUp.Sprite),
+            glm::vec2(this->PositionX[i], this->PositionY[i] - back), powerUp.Size, powerUp.Rotation, powerUp.Color);
+    }
+}
@@ -0,0 +1,60 @@
+#ifndef POWER_UP_POOL_H
+#define POWER_UP_POOL_H
+
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "simd.h"
+#include "power_up.h"
+#include "render_queue.h"
+
+// x interval of a falling power up
+struct PowerUpInterval {
+    float Min, Max;
+    unsigned int Index; // index of the power up in the pool
+};
+
+// PowerUpPool keeps the power ups that are still falling. Their positions are
+// stored as arrays and moved in a single pass, the power up a body turns into
+// when it is caught is kept at the same index. Power ups never move sideways,
+// so their x intervals stay sorted from frame to frame. Removing power ups only
+// flags them, the pool is compacted in one pass per frame.
+class PowerUpPool {
+public:
+    // top left corner of every falling power up
+    AlignedVector<float> PositionX, PositionY;
+    std::vector<PowerUp> Items;
+
+    PowerUpPool();
+    unsigned int Size() const;
+    void Add(const PowerUp& powerUp);
+    void Clear();
+    // moves all power ups down for dt
+    void Fall(float dt);
+    // flags a power up, it is removed by the next Compact
+    void Remove(unsigned int index);
+    bool Removed(unsigned int index) const;
+    // flags all power ups at or below y
+    void RemoveBelow(float y);
+    // replaces the contents of out with the power ups that overlap the box [min, max] and are not
+    // flagged, in ascending order. only the power ups overlapping its x span are tested
+    void Overlapping(glm::vec2 min, glm::vec2 max, std::vector<unsigned int>& out);
+    // removes the flagged power ups, the others keep their order
+    void Compact();
+    // the power up with the position of its body
+    PowerUp Get(unsigned int index) const;
+    // queue all power ups, drawn where they were behind seconds ago
+    void Submit(RenderQueue& queue, float behind);
+private:
+    std::vector<unsigned char> removed;
+    unsigned int removedCount;
+    // sorted by Min, new power ups are sorted in before the next query
+    std::vector<PowerUpInterval> intervals;
+    // Max - Min of the widest interval, bounds how far before a query an overlapping interval can start
+    float maxWidth;
+    // new index of every power up during Compact, kept to reuse its memory
+    std::vector<unsigned int> moved;
+};
+
+#endif
@@ -0,0 +1,101 @@
+#include "render_queue.h"
+#include "gl_state.h"
+
+#include <algorithm>
+#include <unordered_set>
+
+// bit layout of a sort key
+const unsigned int KEY_LAYER_SHIFT = 56;   // 8 bits
+const unsigned int KEY_BLEND_SHIFT = 48;   // 8 bits
+const unsigned int KEY_SHADER_SHIFT = 32;  // 16 bits
+const unsigned int KEY_TEXTURE_SHIFT = 16; // 16 bits
+// the part of a key that describes GL state (everything but the layer)
+const uint64_t KEY_STATE_MASK = (uint64_t(1) << KEY_LAYER_SHIFT) - 1;
+
+RenderQueue::RenderQueue(SpriteRenderer& renderer)
+    : Stats(), renderer(renderer), spriteShader(renderer.GetShader().ID) {}
+
+uint64_t RenderQueue::MakeKey(RenderLayer layer, BlendMode blend, unsigned int shader, unsigned int texture) {
+    return (uint64_t(layer & 0xFF) << KEY_LAYER_SHIFT) | (uint64_t(blend & 0xFF) << KEY_BLEND_SHIFT)
+        | (uint64_t(shader & 0xFFFF) << KEY_SHADER_SHIFT) | (uint64_t(texture & 0xFFFF) << KEY_TEXTURE_SHIFT);
+}
+
+void RenderQueue::SubmitSprite(RenderLayer layer, const void* source, TextureRegion& texture, glm::vec2 position,
+    glm::vec2 size, float rotate, glm::vec3 color) {
+    RenderCommand command;
+    command.Key = MakeKey(layer, BLEND_ALPHA, this->spriteShader, texture.Texture.ID);
+    command.Source = source;
+    command.Texture = &texture;
+    command.Position = position;
+    command.Size = size;
+    command.Rotation = rotate;
+    command.Color = color;
+    this->commands.push_back(command);
+}
+
+void RenderQueue::Submit(uint64_t key, const void* source, std::function<unsigned int()> callback) {
+    RenderCommand command;
+    command.Key = key;
+    command.Source = source;
+    command.Texture = nullptr;
+    command.Callback = callback;
+    this->commands.push_back(command);
+}
+
+void RenderQueue::Execute() {
+    this->Stats = RenderStats();
+
+    // stable, so commands with equal keys keep their submission order
+    std::stable_sort(this->commands.begin(), this->commands.end(),
+        [](const RenderCommand& a, const RenderCommand& b) { return a.Key < b.Key; });
+
+    // sources that already submitted a command with the current key
+    std::unordered_set<const void*> sources;
+    uint64_t lastKey = 0, lastState = 0;
+    bool first = true;
+
+    this->renderer.Begin();
+    for(RenderCommand& command : this->commands) {
+        if(first || command.Key != lastKey)
+            sources.clear();
+        lastKey = command.Key;
+        if(command.Source && !sources.insert(command.Source).second) {
+            this->Stats.Dropped++;
+            continue;
+        }
+
+        uint64_t state = command.Key & KEY_STATE_MASK;
+        if(first || state != lastState) {
+            // pending sprites were batched with the previous state
+            this->Stats.DrawCalls += this->renderer.Flush();
+
+            uint64_t changed = first ? KEY_STATE_MASK : state ^ lastState;
+            if(changed & (uint64_t(0xFF) << KEY_BLEND_SHIFT)) {
+                BlendMode blend = static_cast<BlendMode>((state >> KEY_BLEND_SHIFT) & 0xFF);
+                GLState::BlendFunc(GL_SRC_ALPHA, blend == BLEND_ADDITIVE ? GL_ONE : GL_ONE_MINUS_SRC_ALPHA);
+                this->Stats.StateChanges++;
+            }
+            if(changed & (uint64_t(0xFFFF) << KEY_SHADER_SHIFT))
+                this->Stats.StateChanges++;
+            if(changed & (uint64_t(0xFFFF) << KEY_TEXTURE_SHIFT))
+                this->Stats.StateChanges++;
+
+            lastState = state;
+            first = false;
+        }
+
+        this->Stats.Commands++;
+        if(command.Callback)
+            this->Stats.DrawCalls += command.Callback();
+        else
+            this->renderer.DrawSprite(*command.Texture, command.Position, command.Size, command.Rotation, command.Color);
+    }
+    this->Stats.DrawCalls += this->renderer.Flush();
+    this->renderer.End();
+
+    // restore the default blend mode
+    if(!first && ((lastState >> KEY_BLEND_SHIFT) & 0xFF) != BLEND_ALPHA)
+        GLState::BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    this->commands.clear();
+}
\ No newline at end of file
@@ -0,0 +1,79 @@
+#ifndef RENDER_QUEUE_H
+#define RENDER_QUEUE_H
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include "texture.h"
+#include "sprite_renderer.h"
+
+// render layers, drawn from back to front
+enum RenderLayer {
+    LAYER_BACKGROUND,
+    LAYER_OBJECTS,
+    LAYER_LEVEL,
+    LAYER_PARTICLES,
+    LAYER_BALL
+};
+
+// blend modes a command can request
+enum BlendMode {
+    BLEND_ALPHA,    // GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA (default)
+    BLEND_ADDITIVE  // GL_SRC_ALPHA, GL_ONE
+};
+
+// per frame statistics of the render queue
+struct RenderStats {
+    unsigned int Commands;      // commands executed (after dropping duplicates)
+    unsigned int Dropped;       // duplicate submissions that were dropped
+    unsigned int StateChanges;  // blend / shader / texture changes between commands
+    unsigned int DrawCalls;     // draw calls issued by all commands
+};
+
+// A single draw request. The sort key packs (from most to least significant bits)
+// layer, blend mode, shader and texture, so sorting the queue groups commands
+// with the same render state. Sprite commands are drawn through the batched
+// SpriteRenderer, every other command through its callback.
+struct RenderCommand {
+    uint64_t Key;
+    const void* Source; // submitting object, the same source may only submit once per key
+
+    // sprite command
+    TextureRegion* Texture;
+    glm::vec2 Position, Size;
+    float Rotation;
+    glm::vec3 Color;
+
+    // custom command, returns the number of draw calls issued
+    std::function<unsigned int()> Callback;
+};
+
+// RenderQueue collects the draw commands of all subsystems for a frame, sorts
+// them by their key and executes them once, skipping duplicate submissions and
+// render state that is already set.
+class RenderQueue {
+public:
+    // statistics of the last executed frame
+    RenderStats Stats;
+
+    RenderQueue(SpriteRenderer& renderer);
+    // builds a sort key from the render state of a command
+    static uint64_t MakeKey(RenderLayer layer, BlendMode blend, unsigned int shader, unsigned int texture);
+    // queues a sprite to be drawn through the sprite renderer
+    void SubmitSprite(RenderLayer layer, const void* source, TextureRegion& texture, glm::vec2 position,
+        glm::vec2 size, float rotate = 0.0f, glm::vec3 color = glm::vec3(1.0f));
+    // queues a custom draw callback
+    void Submit(uint64_t key, const void* source, std::function<unsigned int()> callback);
+    // sorts and executes all queued commands and clears the queue
+    void Execute();
+private:
+    SpriteRenderer& renderer;
+    unsigned int spriteShader; // shader used for sprite commands
+    std::vector<RenderCommand> commands;
+};
+
+#endif
\ No newline at end of file
@@ -3,18 +3,24 @@
 #include <iostream>
 #include <sstream>
 #include <fstream>
+#include <set>
 
 #include "stb_image.h"
 
-// note that ResourceManager interfaces directly with OpenGL for glDeleteProgram and glDeleteTextures.
+#include "texture_atlas.h"
+#include "gl_state.h"
+
+// note that ResourceManager deletes programs and textures through GLState, so they are also removed from the state cache.
 // rest interfacing is directly through our Shader and Texture classes
 
 // instantiate static variables
-std::map<std::string, Texture2D> ResourceManager::Textures;
+std::vector<TextureRegion> ResourceManager::Textures(1); // handle 0 is the empty texture
+std::map<std::string, TextureHandle> ResourceManager::TextureHandles;
 std::map<std::string, Shader> ResourceManager::Shaders;
 
-Shader ResourceManager::LoadShader(const char* vShaderFile, const char* fShaderFile, const char* gShaderFile, std::string name) {
-    Shaders[name] = loadShaderFromFile(vShaderFile, fShaderFile, gShaderFile);
+Shader ResourceManager::LoadShader(const char* vShaderFile, const char* fShaderFile, const char* gShaderFile, std::string name,
+                                   const std::vector<const char*>& feedbackVaryings) {
+    Shaders[name] = loadShaderFromFile(vShaderFile, fShaderFile, gShaderFile, feedbackVaryings);
     return Shaders[name];
 }
 
@@ -22,23 +28,77 @@ Shader& ResourceManager::GetShader(std::string name) {
     return Shaders[name]; // return from reference is ok since the variable is part of the class
 }
 
-Texture2D ResourceManager::LoadTexture(const char* file, bool alpha, std::string name) {
-    Textures[name] = loadTextureFromFile(file, alpha);
-    return Textures[name];
+TextureHandle ResourceManager::LoadTexture(const char* file, bool alpha, std::string name) {
+    return storeTexture(name, TextureRegion(loadTextureFromFile(file, alpha)));
 }
 
-Texture2D& ResourceManager::GetTexture(std::string name) {
-    return Textures[name];
+void ResourceManager::LoadTextureAtlas(const std::vector<std::pair<std::string, std::string>>& files, std::string name, unsigned int pageSize) {
+    TextureAtlas atlas(pageSize);
+
+    // images are always loaded with 4 channels, opaque images simply get a full alpha channel
+    for(auto& file : files) {
+        int width, height, nrChannels;
+        unsigned char* data = stbi_load((std::string(FS_SRC_PATH) + file.first).c_str(), &width, &height, &nrChannels, 4);
+        if(!data) {
+            std::cout << "ERROR::TEXTURE: Failed to load " << file.first << std::endl;
+            continue;
+        }
+        atlas.Add(file.second, width, height, data);
+        stbi_image_free(data);
+    }
+
+    if(!atlas.Pack()) {
+        std::cout << "ERROR::TEXTURE: Failed to pack texture atlas " << name << std::endl;
+        return;
+    }
+
+    // generate one texture per atlas page
+    std::vector<Texture2D> pages;
+    for(unsigned int i = 0; i < atlas.Pages.size(); i++) {
+        Texture2D page;
+        page.Internal_Format = GL_RGBA;
+        page.Image_Format = GL_RGBA;
+        page.Wrap_S = GL_CLAMP_TO_EDGE;
+        page.Wrap_T = GL_CLAMP_TO_EDGE;
+        page.Generate(atlas.Pages[i].Width, atlas.Pages[i].Height, atlas.Pages[i].Pixels.data());
+        pages.push_back(page);
+        storeTexture(name + std::to_string(i), TextureRegion(page));
+    }
+
+    for(auto& region : atlas.Regions)
+        storeTexture(region.first, TextureRegion(pages[region.second.Page], atlas.UV(region.second)));
+}
+
+TextureHandle ResourceManager::GetTextureHandle(std::string name) {
+    auto it = TextureHandles.find(name);
+    return it != TextureHandles.end() ? it->second : 0;
+}
+
+TextureRegion& ResourceManager::GetTexture(TextureHandle handle) {
+    return Textures[handle];
+}
+
+TextureRegion& ResourceManager::GetTexture(std::string name) {
+    return Textures[GetTextureHandle(name)];
 }
 
 void ResourceManager::Clear() {
     for(auto iter : Shaders)
-        glDeleteProgram(iter.second.ID);
-    for(auto iter : Textures)
-        glDeleteTextures(1, &iter.second.ID);
+        GLState::DeleteProgram(iter.second.ID);
+
+    // atlas regions share their page texture, delete every texture only once
+    std::set<unsigned int> textures;
+    for(TextureRegion& region : Textures)
+        if(region.Texture.ID)
+            textures.insert(region.Texture.ID);
+    for(unsigned int texture : textures)
+        GLState::DeleteTexture(texture);
+    Textures.resize(1);
+    TextureHandles.clear();
 }
 
-Shader ResourceManager::loadShaderFromFile(const char* vShaderFile, const char* fShaderFile, const char* gShaderFile) {
+Shader ResourceManager::loadShaderFromFile(const char* vShaderFile, const char* fShaderFile, const char* gShaderFile,
+                                           const std::vector<const char*>& feedbackVaryings) {
     std::string vertexCode, fragmentCode, geometryCode;
 
     try {
@@ -94,7 +154,7 @@ Shader ResourceManager::loadShaderFromFile(const char* vShaderFile, const char*
 
     // 2. now create shader object from source code
     Shader shader;
-    shader.Compile(vShaderCode, fShaderCode, gShaderFile != nullptr ? gShaderCode : nullptr);
+    shader.Compile(vShaderCode, fShaderCode, gShaderFile != nullptr ? gShaderCode : nullptr, feedbackVaryings);
 
     return shader;
 }
@@ -116,4 +176,16 @@ Texture2D ResourceManager::loadTextureFromFile(const char* file, bool alpha) {
     // and finally free image data
     stbi_image_free(data);
     return texture;
-}
\ No newline at end of file
+}
+
+TextureHandle ResourceManager::storeTexture(std::string name, TextureRegion texture) {
+    auto it = TextureHandles.find(name);
+    if(it != TextureHandles.end()) {
+        Textures[it->second] = texture;
+        return it->second;
+    }
+    TextureHandle handle = Textures.size();
+    Textures.push_back(texture);
+    TextureHandles[name] = handle;
+    return handle;
+}
@@ -3,6 +3,8 @@
 
 #include <map>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include <glad/glad.h>
 
@@ -17,16 +19,27 @@ class ResourceManager {
 public:
     // resource storage
     static std::map<std::string, Shader> Shaders;
-    static std::map<std::string, Texture2D> Textures;
+    // textures are stored as regions, so atlas packed and standalone textures are used the same way.
+    // the table is indexed by TextureHandle, Textures[0] is an empty texture
+    static std::vector<TextureRegion> Textures;
+    static std::map<std::string, TextureHandle> TextureHandles;
     // loads (and generates) a shader program from file, loading vertex, fragment (and geometry) shader's source code.
-    // if gShaderFile is not nullptr, it also loads a geometry shader
-    static Shader LoadShader(const char* vShaderFile, const char* fShaderFile, const char* gShaderFile, std::string name);
+    // if gShaderFile is not nullptr, it also loads a geometry shader. the outputs named in
+    // feedbackVaryings are captured by transform feedback
+    static Shader LoadShader(const char* vShaderFile, const char* fShaderFile, const char* gShaderFile, std::string name,
+                             const std::vector<const char*>& feedbackVaryings = {});
     // retrieves a stored shader
     static Shader& GetShader(std::string name);
     // loads (and generates) a texture from file
-    static Texture2D LoadTexture(const char* file, bool alpha, std::string name);
-    // retrieves a stored texture
-    static Texture2D& GetTexture(std::string name);
+    static TextureHandle LoadTexture(const char* file, bool alpha, std::string name);
+    // loads a list of <file, name> images and packs them into atlas pages named `name` followed by the page number.
+    // every image is stored under its own name as a region of its atlas page
+    static void LoadTextureAtlas(const std::vector<std::pair<std::string, std::string>>& files, std::string name, unsigned int pageSize = 2048);
+    // retrieves the handle of a stored texture, 0 if there is no texture with this name
+    static TextureHandle GetTextureHandle(std::string name);
+    // retrieves a stored texture (an atlas page plus uv rectangle)
+    static TextureRegion& GetTexture(TextureHandle handle);
+    static TextureRegion& GetTexture(std::string name);
 
     static void Clear(); // de-allocate all our resources
 private:
@@ -34,9 +47,12 @@ private:
     Its members and functions should be publicly available (static).
     ResourceManager() {}
     // loads and generates a shader from file
-    static Shader loadShaderFromFile(const char *vShaderFile, const char *fShaderFile, const char *gShaderFile = nullptr);
+    static Shader loadShaderFromFile(const char *vShaderFile, const char *fShaderFile, const char *gShaderFile = nullptr,
+                                     const std::vector<const char*>& feedbackVaryings = {});
     // loads a single texture from file
     static Texture2D loadTextureFromFile(const char *file, bool alpha);
+    // stores a texture under a name, reusing the handle if the name is already taken
+    static TextureHandle storeTexture(std::string name, TextureRegion texture);
 };
 
 #endif
\ No newline at end of file
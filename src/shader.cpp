@@ -1,31 +1,25 @@
 #include "shader.h"
 
+#include <algorithm>
+#include <climits>
+#include <cstring>
 #include <iostream>
 
+#include "gl_state.h"
+
 Shader& Shader::Use() {
-    glUseProgram(this->ID);
+    GLState::UseProgram(this->ID);
     return *this;
 }
 
-void Shader::Compile(const char* vertexSource, const char* fragmentSource, const char *geometrySource) {
+void Shader::Compile(const char* vertexSource, const char* fragmentSource, const char *geometrySource,
+                     const std::vector<const char*>& feedbackVaryings) {
     unsigned int sVertex, sFragment, gShader;
 
-    sVertex = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(sVertex, 1, &vertexSource, NULL);
-    glCompileShader(sVertex);
-    checkCompileErrors(sVertex, "VERTEX");
-    // fragment shader
-    sFragment = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(sFragment, 1, &fragmentSource, NULL);
-    glCompileShader(sFragment);
-    checkCompileErrors(sFragment, "FRAGMENT");
-
-    if(geometrySource != nullptr) {
-        gShader = glCreateShader(GL_GEOMETRY_SHADER);
-        glShaderSource(gShader, 1, &geometrySource, NULL);
-        glCompileShader(gShader);
-        checkCompileErrors(gShader, "GEOMETRY");
-    }
+    sVertex = compileStage(GL_VERTEX_SHADER, vertexSource, "VERTEX");
+    sFragment = compileStage(GL_FRAGMENT_SHADER, fragmentSource, "FRAGMENT");
+    if(geometrySource != nullptr)
+        gShader = compileStage(GL_GEOMETRY_SHADER, geometrySource, "GEOMETRY");
 
     // shader program
     this->ID = glCreateProgram();
@@ -34,9 +28,14 @@ void Shader::Compile(const char* vertexSource, const char* fragmentSource, const
 
     if(geometrySource)
         glAttachShader(this->ID, gShader);
+    // the captured outputs are part of the link
+    if(!feedbackVaryings.empty())
+        glTransformFeedbackVaryings(this->ID, feedbackVaryings.size(), feedbackVaryings.data(), GL_INTERLEAVED_ATTRIBS);
 
     glLinkProgram(this->ID);
     checkCompileErrors(this->ID, "PROGRAM");
+    buildUniformTable();
+    bindFrameUniforms();
 
     // delete te shader parts as they have been linked to shader program now
     glDeleteShader(sVertex);
@@ -45,60 +44,120 @@ void Shader::Compile(const char* vertexSource, const char* fragmentSource, const
         glDeleteShader(gShader);
 }
 
-void Shader::SetFloat(const char* name, float value, bool useShader) {
+int Shader::GetUniform(UniformName name) const {
+    auto it = std::lower_bound(this->uniforms.begin(), this->uniforms.end(), std::make_pair(name.Hash, INT_MIN));
+    if(it == this->uniforms.end() || it->first != name.Hash)
+        return -1;
+    return it->second;
+}
+
+int Shader::GetUniform(const char* name) const {
+    return this->GetUniform(UniformName(name));
+}
+
+void Shader::SetFloat(int location, float value, bool useShader) {
     if(useShader)
         this->Use();
 
-    glUniform1f(glGetUniformLocation(this->ID, name), value);
+    glUniform1f(location, value);
 }
 
-void Shader::SetInteger(const char *name, int value, bool useShader)
+void Shader::SetInteger(int location, int value, bool useShader)
 {
     if (useShader)
         this->Use();
-    glUniform1i(glGetUniformLocation(this->ID, name), value);
+    glUniform1i(location, value);
 }
-void Shader::SetVector2f(const char *name, float x, float y, bool useShader)
+void Shader::SetVector2f(int location, float x, float y, bool useShader)
 {
     if (useShader)
         this->Use();
-    glUniform2f(glGetUniformLocation(this->ID, name), x, y);
+    glUniform2f(location, x, y);
 }
-void Shader::SetVector2f(const char *name, const glm::vec2 &value, bool useShader)
+void Shader::SetVector2f(int location, const glm::vec2 &value, bool useShader)
 {
     if (useShader)
         this->Use();
-    glUniform2f(glGetUniformLocation(this->ID, name), value.x, value.y);
+    glUniform2f(location, value.x, value.y);
 }
-void Shader::SetVector3f(const char *name, float x, float y, float z, bool useShader)
+void Shader::SetVector3f(int location, float x, float y, float z, bool useShader)
 {
     if (useShader)
         this->Use();
-    glUniform3f(glGetUniformLocation(this->ID, name), x, y, z);
+    glUniform3f(location, x, y, z);
 }
-void Shader::SetVector3f(const char *name, const glm::vec3 &value, bool useShader)
+void Shader::SetVector3f(int location, const glm::vec3 &value, bool useShader)
 {
     if (useShader)
         this->Use();
-    glUniform3f(glGetUniformLocation(this->ID, name), value.x, value.y, value.z);
+    glUniform3f(location, value.x, value.y, value.z);
 }
-void Shader::SetVector4f(const char *name, float x, float y, float z, float w, bool useShader)
+void Shader::SetVector4f(int location, float x, float y, float z, float w, bool useShader)
 {
     if (useShader)
         this->Use();
-    glUniform4f(glGetUniformLocation(this->ID, name), x, y, z, w);
+    glUniform4f(location, x, y, z, w);
 }
-void Shader::SetVector4f(const char *name, const glm::vec4 &value, bool useShader)
+void Shader::SetVector4f(int location, const glm::vec4 &value, bool useShader)
 {
     if (useShader)
         this->Use();
-    glUniform4f(glGetUniformLocation(this->ID, name), value.x, value.y, value.z, value.w);
+    glUniform4f(location, value.x, value.y, value.z, value.w);
 }
-void Shader::SetMatrix4(const char *name, const glm::mat4 &matrix, bool useShader)
+void Shader::SetMatrix4(int location, const glm::mat4 &matrix, bool useShader)
 {
     if (useShader)
         this->Use();
-    glUniformMatrix4fv(glGetUniformLocation(this->ID, name), 1, false, glm::value_ptr(matrix));
+    glUniformMatrix4fv(location, 1, false, glm::value_ptr(matrix));
+}
+
+void Shader::buildUniformTable() {
+    this->uniforms.clear();
+
+    int count = 0, maxLength = 0;
+    glGetProgramiv(this->ID, GL_ACTIVE_UNIFORMS, &count);
+    glGetProgramiv(this->ID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+    std::vector<char> name(maxLength + 1);
+
+    for(int i = 0; i < count; i++) {
+        int length = 0, size = 0;
+        GLenum type;
+        glGetActiveUniform(this->ID, i, name.size(), &length, &size, &type, name.data());
+        int location = glGetUniformLocation(this->ID, name.data());
+        if(location < 0)
+            continue; // uniforms inside uniform blocks have no location
+
+        this->uniforms.push_back(std::make_pair(HashUniformName(name.data()), location));
+        // arrays are reported as `name[0]`, also make them available by their plain name
+        std::string plain(name.data(), length);
+        if(plain.size() > 3 && plain.compare(plain.size() - 3, 3, "[0]") == 0)
+            this->uniforms.push_back(std::make_pair(HashUniformName(plain.substr(0, plain.size() - 3).c_str()), location));
+    }
+
+    std::sort(this->uniforms.begin(), this->uniforms.end());
+    for(unsigned int i = 1; i < this->uniforms.size(); i++)
+        if(this->uniforms[i].first == this->uniforms[i - 1].first)
+            std::cout << "| ERROR::SHADER: uniform name hash collision in program " << this->ID << std::endl;
+}
+
+void Shader::bindFrameUniforms() {
+    unsigned int index = glGetUniformBlockIndex(this->ID, FRAME_UNIFORM_BLOCK);
+    if(index != GL_INVALID_INDEX)
+        glUniformBlockBinding(this->ID, index, FRAME_UNIFORM_BINDING);
+}
+
+unsigned int Shader::compileStage(GLenum type, const char* source, std::string name) {
+    // the #version line has to come first, the block goes between it and the rest of the source
+    const char* rest = std::strchr(source, '\n');
+    rest = rest ? rest + 1 : source + std::strlen(source);
+    const char* sources[] = { source, FRAME_UNIFORM_SOURCE, rest };
+    const int lengths[] = { static_cast<int>(rest - source), -1, -1 };
+
+    unsigned int shader = glCreateShader(type);
+    glShaderSource(shader, 3, sources, lengths);
+    glCompileShader(shader);
+    checkCompileErrors(shader, name);
+    return shader;
 }
 
 void Shader::checkCompileErrors(unsigned int object, std::string type) {
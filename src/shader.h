@@ -1,33 +1,99 @@
 #ifndef SHADER_H
 #define SHADER_H
 
+#include <cstdint>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include <glad/glad.h>
 #include <glm/glm.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
+// uniform block shared by all shaders for per frame data (projection, time, effect flags)
+// and the binding point its buffer is attached to, see FrameUniforms
+const char* const FRAME_UNIFORM_BLOCK = "FrameData";
+const unsigned int FRAME_UNIFORM_BINDING = 0;
+// declaration of the FrameData block, Compile puts it right after the `#version` line of every stage
+// so the shaders don't declare it themselves. it has to match FrameUniformData in frame_uniforms.h
+// the trailing #line keeps the line numbers of compile errors those of the shader file
+const char* const FRAME_UNIFORM_SOURCE =
+    "layout (std140) uniform FrameData {\n"
+    "    mat4 projection;\n"
+    "    float time;\n"
+    "    bool confuse;\n"
+    "    bool chaos;\n"
+    "    bool shake;\n"
+    "    bool grayscale;\n"
+    "};\n"
+    "#line 2\n";
+
+// FNV-1a hash of a uniform name
+constexpr uint32_t HashUniformName(const char* name, uint32_t hash = 2166136261u) {
+    return *name ? HashUniformName(name + 1, (hash ^ static_cast<uint8_t>(*name)) * 16777619u) : hash;
+}
+
+// a uniform name hashed at compile time, e.g. `constexpr UniformName MODEL("model");`
+// looking a uniform up by its hash never compares strings or queries the driver
+struct UniformName {
+    uint32_t Hash;
+    constexpr explicit UniformName(const char* name) : Hash(HashUniformName(name)) {}
+};
+
 // general purpose shader object
+// after linking, all active uniforms are stored in a flat table sorted by name hash,
+// so uniforms can be set by a pre-resolved location, a hashed name or (slowest) a string
 class Shader {
 public:
     unsigned int ID;
     Shader() {}
     Shader& Use();
     // compiles the shader from given source code
-    void    Compile(const char *vertexSource, const char *fragmentSource, const char *geometrySource = nullptr); // note: geometry source code is optional 
+    // the outputs named in feedbackVaryings are captured interleaved by transform feedback
+    void    Compile(const char *vertexSource, const char *fragmentSource, const char *geometrySource = nullptr,
+                    const std::vector<const char*>& feedbackVaryings = {}); // note: geometry source code is optional 
+    // resolves the location of a uniform from the uniform table (-1 if it is not active)
+    int     GetUniform  (UniformName name) const;
+    int     GetUniform  (const char *name) const;
     // utility functions
-    void    SetFloat    (const char *name, float value, bool useShader = false);
-    void    SetInteger  (const char *name, int value, bool useShader = false);
-    void    SetVector2f (const char *name, float x, float y, bool useShader = false);
-    void    SetVector2f (const char *name, const glm::vec2 &value, bool useShader = false);
-    void    SetVector3f (const char *name, float x, float y, float z, bool useShader = false);
-    void    SetVector3f (const char *name, const glm::vec3 &value, bool useShader = false);
-    void    SetVector4f (const char *name, float x, float y, float z, float w, bool useShader = false);
-    void    SetVector4f (const char *name, const glm::vec4 &value, bool useShader = false);
-    void    SetMatrix4  (const char *name, const glm::mat4 &matrix, bool useShader = false);
+    void    SetFloat    (int location, float value, bool useShader = false);
+    void    SetInteger  (int location, int value, bool useShader = false);
+    void    SetVector2f (int location, float x, float y, bool useShader = false);
+    void    SetVector2f (int location, const glm::vec2 &value, bool useShader = false);
+    void    SetVector3f (int location, float x, float y, float z, bool useShader = false);
+    void    SetVector3f (int location, const glm::vec3 &value, bool useShader = false);
+    void    SetVector4f (int location, float x, float y, float z, float w, bool useShader = false);
+    void    SetVector4f (int location, const glm::vec4 &value, bool useShader = false);
+    void    SetMatrix4  (int location, const glm::mat4 &matrix, bool useShader = false);
+    // by hashed name
+    void    SetFloat    (UniformName name, float value, bool useShader = false)                 { SetFloat(GetUniform(name), value, useShader); }
+    void    SetInteger  (UniformName name, int value, bool useShader = false)                   { SetInteger(GetUniform(name), value, useShader); }
+    void    SetVector2f (UniformName name, const glm::vec2 &value, bool useShader = false)      { SetVector2f(GetUniform(name), value, useShader); }
+    void    SetVector3f (UniformName name, const glm::vec3 &value, bool useShader = false)      { SetVector3f(GetUniform(name), value, useShader); }
+    void    SetVector4f (UniformName name, const glm::vec4 &value, bool useShader = false)      { SetVector4f(GetUniform(name), value, useShader); }
+    void    SetMatrix4  (UniformName name, const glm::mat4 &matrix, bool useShader = false)     { SetMatrix4(GetUniform(name), matrix, useShader); }
+    // by string (hashed at runtime)
+    void    SetFloat    (const char *name, float value, bool useShader = false)                 { SetFloat(GetUniform(name), value, useShader); }
+    void    SetInteger  (const char *name, int value, bool useShader = false)                   { SetInteger(GetUniform(name), value, useShader); }
+    void    SetVector2f (const char *name, float x, float y, bool useShader = false)            { SetVector2f(GetUniform(name), x, y, useShader); }
+    void    SetVector2f (const char *name, const glm::vec2 &value, bool useShader = false)      { SetVector2f(GetUniform(name), value, useShader); }
+    void    SetVector3f (const char *name, float x, float y, float z, bool useShader = false)   { SetVector3f(GetUniform(name), x, y, z, useShader); }
+    void    SetVector3f (const char *name, const glm::vec3 &value, bool useShader = false)      { SetVector3f(GetUniform(name), value, useShader); }
+    void    SetVector4f (const char *name, float x, float y, float z, float w, bool useShader = false) { SetVector4f(GetUniform(name), x, y, z, w, useShader); }
+    void    SetVector4f (const char *name, const glm::vec4 &value, bool useShader = false)      { SetVector4f(GetUniform(name), value, useShader); }
+    void    SetMatrix4  (const char *name, const glm::mat4 &matrix, bool useShader = false)     { SetMatrix4(GetUniform(name), matrix, useShader); }
 private:
+    // <name hash, location> of every active uniform, sorted by hash
+    std::vector<std::pair<uint32_t, int>> uniforms;
+
+    // compiles one stage, with the FrameData block inserted after its `#version` line
+    unsigned int compileStage(GLenum type, const char* source, std::string name);
     // checks if compilation or linking failed and if so, print the error logs
     void    checkCompileErrors(unsigned int object, std::string type); 
+    // fills the uniform table from the linked program
+    void    buildUniformTable();
+    // attaches the per frame uniform block (if the program uses it) to its binding point
+    void    bindFrameUniforms();
 };
 
 #endif
\ No newline at end of file
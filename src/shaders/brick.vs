@@ -0,0 +1,27 @@
+#version 330 core
+layout (location = 0) in vec4 vertex; // <vec2 position, vec2 texCoords>
+layout (location = 1) in vec4 rect; // per instance <vec2 position, vec2 size>
+layout (location = 2) in uvec2 data; // per instance <uint palette, uint flags>
+
+out vec2 TexCoords;
+out vec3 BrickColor;
+
+// the per frame FrameData block (projection, time, effect flags) is prepended by Shader::Compile
+uniform vec3 palette[8];
+// <vec2 min, vec2 max> of the block and solid block sprites on the atlas page
+uniform vec4 blockUV;
+uniform vec4 blockSolidUV;
+
+const uint BRICK_ALIVE = 1u;
+const uint BRICK_SOLID = 2u;
+
+void main() {
+    vec4 uv = (data.y & BRICK_SOLID) != 0u ? blockSolidUV : blockUV;
+    TexCoords = mix(uv.xy, uv.zw, vertex.zw);
+    BrickColor = palette[data.x];
+
+    if((data.y & BRICK_ALIVE) == 0u)
+        gl_Position = vec4(2.0, 2.0, 2.0, 1.0); // destroyed: collapse outside the clip volume
+    else
+        gl_Position = projection * vec4(rect.xy + vertex.xy * rect.zw, 0.0, 1.0);
+}
\ No newline at end of file
@@ -1,16 +1,17 @@
 #version 330 core
 layout (location = 0) in vec4 vertex; // <vec2 position, vec2 texCoords>
+layout (location = 1) in vec2 offset; // per instance
+layout (location = 2) in vec4 color;  // per instance
 
 out vec2 TexCoords;
 out vec4 ParticleColor;
 
-uniform mat4 projection;
-uniform vec2 offset;
-uniform vec4 color;
+// the per frame FrameData block (projection, time, effect flags) is prepended by Shader::Compile
+uniform vec4 uvRect; // <vec2 min, vec2 max> of the sprite on its atlas page
 
 void main() {
     float scale = 4.0f;
-    TexCoords = vertex.zw;
+    TexCoords = mix(uvRect.xy, uvRect.zw, vertex.zw);
     ParticleColor = color;
     gl_Position = projection * vec4((vertex.xy * scale) + offset, 0.0, 1.0);
-}
\ No newline at end of file
+}
@@ -0,0 +1,5 @@
+#version 330 core
+// the particle update only runs the vertex stage, rasterization is discarded
+
+void main() {
+}
@@ -0,0 +1,72 @@
+#version 330 core
+// advances the particle state by one update, the outputs are captured by transform feedback
+layout (location = 0) in vec2 position;
+layout (location = 1) in vec2 velocity;
+layout (location = 2) in vec4 color;
+layout (location = 3) in vec2 life; // <remaining life, alpha lost per second>
+
+out vec2 outPosition;
+out vec2 outVelocity;
+out vec4 outColor;
+out vec2 outLife;
+
+// emitter parameters of the particles spawned this update (see ParticleFeedbackSpawn)
+struct Spawn {
+    vec4 motion; // <vec2 position, vec2 velocity>
+    vec4 color;
+    vec4 shape;  // <spread, speed, inherited velocity, color variance>
+    vec2 life;   // <lifetime, alpha lost per second>
+    uvec2 range; // <first, count> of the spawned particles, wraps around the end of the buffer
+};
+const int MAX_SPAWNS = 32; // GPU_PARTICLE_SPAWNS
+layout (std140) uniform SpawnData {
+    Spawn spawns[MAX_SPAWNS];
+    uint spawnCount;
+    uint seed;
+    float deltaTime;
+    uint capacity;
+};
+
+// integer hash (lowbias32), the random numbers only depend on the particle and the update
+uint hash(uint x) {
+    x ^= x >> 16; x *= 0x7FEB352Du;
+    x ^= x >> 15; x *= 0x846CA68Bu;
+    x ^= x >> 16;
+    return x;
+}
+
+float random(inout uint state) {
+    state = hash(state);
+    return float(state >> 8) * (1.0 / 16777216.0);
+}
+
+void main() {
+    uint id = uint(gl_VertexID);
+    for (uint i = 0u; i < spawnCount; ++i) {
+        if ((id + capacity - spawns[i].range.x) % capacity >= spawns[i].range.y)
+            continue;
+        // born this update, replacing whatever was in this slot
+        uint state = hash(id ^ hash(seed));
+        vec2 jitter = (vec2(random(state), random(state)) * 2.0 - 1.0) * spawns[i].shape.x;
+        float shade = 1.0 + (random(state) * 2.0 - 1.0) * spawns[i].shape.w;
+        float angle = random(state) * 6.28318530718;
+        float speed = random(state) * spawns[i].shape.y;
+        outPosition = spawns[i].motion.xy + jitter;
+        outVelocity = spawns[i].motion.zw * spawns[i].shape.z + vec2(cos(angle), sin(angle)) * speed;
+        outColor = vec4(spawns[i].color.rgb * shade, spawns[i].color.a);
+        outLife = spawns[i].life;
+        return;
+    }
+
+    float remaining = life.x - deltaTime;
+    outVelocity = velocity;
+    outLife = vec2(remaining, life.y);
+    if (remaining > 0.0) {
+        outPosition = position + velocity * deltaTime;
+        outColor = vec4(color.rgb, color.a - life.y * deltaTime);
+    } else {
+        // dead particles are moved out of view, so drawing them produces no fragments
+        outPosition = vec2(-1.0e6);
+        outColor = vec4(color.rgb, 0.0);
+    }
+}
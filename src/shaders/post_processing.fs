@@ -7,10 +7,7 @@ uniform vec2 offsets[9];
 uniform int edge_kernel[9];
 uniform float blur_kernel[9];
 
-uniform bool chaos;
-uniform bool confuse;
-uniform bool shake;
-uniform bool grayscale;
+// the per frame FrameData block (projection, time, effect flags) is prepended by Shader::Compile
 
 void main() {
     // set to zero, as `out` variable is initialized with undefined values by default 
@@ -3,10 +3,7 @@ layout (location = 0) in vec4 vertex; // vec2 position, vec2 texCoords
 
 out vec2 TexCoords;
 
-uniform bool chaos;
-uniform bool confuse;
-uniform bool shake;
-uniform float time;
+// the per frame FrameData block (projection, time, effect flags) is prepended by Shader::Compile
 
 void main() {
     gl_Position = vec4(vertex.xy, 0.0f, 1.0f);
@@ -1,13 +1,16 @@
 #version 330 core
 layout (location = 0) in vec4 vertex; // <vec2 position, vec2 texCoords>
+layout (location = 1) in vec3 color;
 
 out vec2 TexCoords;
+out vec3 SpriteColor;
 
-uniform mat4 model;
+// sprites are batched, so vertex positions are already in world space (no model matrix)
 // no need of view matrix since our game is a single scene (no camera movement)
-uniform mat4 projection;
+// the per frame FrameData block (projection, time, effect flags) is prepended by Shader::Compile
 
 void main() {
     TexCoords = vertex.zw;
-    gl_Position = projection * model * vec4(vertex.xy, 0.0, 1.0);
+    SpriteColor = color;
+    gl_Position = projection * vec4(vertex.xy, 0.0, 1.0);
 }
\ No newline at end of file
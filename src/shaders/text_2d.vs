@@ -3,7 +3,7 @@ layout (location = 0) in vec4 vertex; // vec2 pos, vec2 texCoords
 
 out vec2 TexCoords;
 
-uniform mat4 projection;
+// the per frame FrameData block (projection, time, effect flags) is prepended by Shader::Compile
 
 void main() {
     gl_Position = projection * vec4(vertex.xy, 0.0, 1.0);
@@ -0,0 +1,57 @@
+#include "simd.h"
+
+#include <algorithm>
+
+// scale of the 24 random bits that are converted to a float in [0, 1)
+const float RANDOM_SCALE = 1.0f / 16777216.0f;
+
+SimdRandom::SimdRandom(uint32_t seed) {
+    this->Seed(seed);
+}
+
+void SimdRandom::Seed(uint32_t seed) {
+    // derive a distinct, non zero state for every lane (splitmix32 style mixing)
+    for(unsigned int i = 0; i < SIMD_RANDOM_LANES; i++) {
+        uint32_t z = seed + 0x9E3779B9u * (i + 1);
+        z = (z ^ (z >> 16)) * 0x85EBCA6Bu;
+        z = (z ^ (z >> 13)) * 0xC2B2AE35u;
+        z ^= z >> 16;
+        this->state[i] = z ? z : 0x6D2B79F5u;
+    }
+}
+
+void SimdRandom::Uniform(float* out, unsigned int count) {
+    unsigned int i = 0;
+    for(; i + SIMD_RANDOM_LANES <= count; i += SIMD_RANDOM_LANES)
+        this->next(out + i);
+    if(i < count) {
+        float rest[SIMD_RANDOM_LANES];
+        this->next(rest);
+        std::copy(rest, rest + (count - i), out + i);
+    }
+}
+
+void SimdRandom::next(float* out) {
+#if defined(SIMD_SSE2)
+    // xorshift32 on 4 lanes per register, AVX without AVX2 has no 256 bit integer shifts
+    const __m128 scale = _mm_set1_ps(RANDOM_SCALE);
+    for(unsigned int lane = 0; lane < SIMD_RANDOM_LANES; lane += 4) {
+        __m128i x = _mm_load_si128(reinterpret_cast<const __m128i*>(&this->state[lane]));
+        x = _mm_xor_si128(x, _mm_slli_epi32(x, 13));
+        x = _mm_xor_si128(x, _mm_srli_epi32(x, 17));
+        x = _mm_xor_si128(x, _mm_slli_epi32(x, 5));
+        _mm_store_si128(reinterpret_cast<__m128i*>(&this->state[lane]), x);
+        // the top 24 bits fit into a float mantissa exactly
+        _mm_storeu_ps(out + lane, _mm_mul_ps(_mm_cvtepi32_ps(_mm_srli_epi32(x, 8)), scale));
+    }
+#else
+    for(unsigned int lane = 0; lane < SIMD_RANDOM_LANES; lane++) {
+        uint32_t x = this->state[lane];
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        this->state[lane] = x;
+        out[lane] = (x >> 8) * RANDOM_SCALE;
+    }
+#endif
+}
@@ -0,0 +1,74 @@
+#ifndef SIMD_H
+#define SIMD_H
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <vector>
+
+// the widest instruction set enabled by the compiler flags is used (-mavx, -mavx2),
+// x86-64 always has SSE2. other targets use the scalar fallbacks.
+#if defined(__AVX__)
+#include <immintrin.h>
+#define SIMD_AVX 1
+#define SIMD_SSE2 1
+const unsigned int SIMD_WIDTH = 8; // floats per register
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define SIMD_SSE2 1
+const unsigned int SIMD_WIDTH = 4;
+#else
+const unsigned int SIMD_WIDTH = 1;
+#endif
+
+// alignment of SIMD arrays, enough for AVX loads and stores
+const std::size_t SIMD_ALIGNMENT = 32;
+// SIMD arrays are padded to a multiple of this many elements, so kernels never need a scalar tail
+const unsigned int SIMD_PADDING = 8;
+
+// rounds a count up to a multiple of SIMD_PADDING
+inline unsigned int SimdPadded(unsigned int count) {
+    return (count + SIMD_PADDING - 1) / SIMD_PADDING * SIMD_PADDING;
+}
+
+// allocator for std::vector that aligns its storage for aligned SIMD loads
+template<typename T>
+struct AlignedAllocator {
+    typedef T value_type;
+
+    AlignedAllocator() {}
+    template<typename U> AlignedAllocator(const AlignedAllocator<U>&) {}
+
+    T* allocate(std::size_t n) {
+        return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(SIMD_ALIGNMENT)));
+    }
+    void deallocate(T* p, std::size_t) {
+        ::operator delete(p, std::align_val_t(SIMD_ALIGNMENT));
+    }
+    template<typename U> bool operator==(const AlignedAllocator<U>&) const { return true; }
+    template<typename U> bool operator!=(const AlignedAllocator<U>&) const { return false; }
+};
+
+template<typename T>
+using AlignedVector = std::vector<T, AlignedAllocator<T>>;
+
+// number of independent xorshift streams of SimdRandom
+const unsigned int SIMD_RANDOM_LANES = 8;
+
+// SimdRandom generates uniform random numbers with SIMD_RANDOM_LANES xorshift32
+// generators that are stepped together. The SIMD and the scalar code produce
+// the same sequence, so a seed gives the same results on every build.
+class SimdRandom {
+public:
+    SimdRandom(uint32_t seed = 1);
+    void Seed(uint32_t seed);
+    // fills out with count numbers in [0, 1)
+    void Uniform(float* out, unsigned int count);
+private:
+    alignas(SIMD_ALIGNMENT) uint32_t state[SIMD_RANDOM_LANES];
+
+    // advances every lane once and writes one number per lane
+    void next(float* out);
+};
+
+#endif
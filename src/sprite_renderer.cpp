@@ -1,66 +1,108 @@
 #include "sprite_renderer.h"
+#include "gl_state.h"
+#include "stream_buffer.h"
 
-SpriteRenderer::SpriteRenderer(Shader& shader) {
+#include <cmath>
+#include <cstddef>
+
+// initial size of the CPU vertex batch (in sprites), grows as needed
+const unsigned int INITIAL_BATCH_SPRITES = 256;
+
+SpriteRenderer::SpriteRenderer(Shader& shader)
+    : batchTexture(0), batching(false) {
     this->shader = shader;
     this->initRenderData();
 }
 
 SpriteRenderer::~SpriteRenderer() {
-    glDeleteVertexArrays(1, &this->quadVAO);
+    GLState::DeleteVertexArray(this->quadVAO);
 }
 
-void SpriteRenderer::DrawSprite(Texture2D &texture, glm::vec2 position, glm::vec2 size, float rotate, glm::vec3 color) {
-    this->shader.Use();
-    glm::mat4 model = glm::mat4(1.0f);
-    // we can directly use glm::translate with position as point is at origin
-    // hence, the TOP LEFT vertex of the quad is equal to `position`
-    // i.e we consider the `position` for quad as equal to position of top left corner
-    model = glm::translate(model, glm::vec3(position, 0.0f)); 
+void SpriteRenderer::Begin() {
+    this->batching = true;
+}
 
-    // rotation around center
-    model = glm::translate(model, glm::vec3(0.5f * size.x, 0.5f * size.y, 0.0));
-    model = glm::rotate(model, glm::radians(rotate), glm::vec3(0.0, 0.0, 1.0));
-    model = glm::translate(model, glm::vec3(-0.5f * size.x, -0.5f * size.y, 0.0));
+void SpriteRenderer::End() {
+    this->Flush();
+    this->batching = false;
+}
 
-    model = glm::scale(model, glm::vec3(size, 1.0f));
-    // read upwards from here for actual order in which transformations are performed
+void SpriteRenderer::DrawSprite(TextureRegion &texture, glm::vec2 position, glm::vec2 size, float rotate, glm::vec3 color) {
+    // a texture switch ends the current batch, sprites on the same atlas page share a batch
+    if(!this->vertices.empty() && texture.Texture.ID != this->batchTexture)
+        this->Flush();
+    this->batchTexture = texture.Texture.ID;
 
-    this->shader.SetMatrix4("model", model);
+    // the quad's TOP LEFT vertex is equal to `position`
+    glm::vec2 corners[4]; // top left, top right, bottom left, bottom right
+    if(rotate == 0.0f) {
+        // fast path: axis aligned quad, no need for a rotation
+        corners[0] = position;
+        corners[1] = glm::vec2(position.x + size.x, position.y);
+        corners[2] = glm::vec2(position.x, position.y + size.y);
+        corners[3] = position + size;
+    } else {
+        // rotation around center
+        float angle = glm::radians(rotate);
+        float c = std::cos(angle), s = std::sin(angle);
+        glm::vec2 half = 0.5f * size;
+        glm::vec2 center = position + half;
+        glm::vec2 offsets[4] = {
+            glm::vec2(-half.x, -half.y), glm::vec2(half.x, -half.y),
+            glm::vec2(-half.x,  half.y), glm::vec2(half.x,  half.y)
+        };
+        for(unsigned int i = 0; i < 4; i++)
+            corners[i] = center + glm::vec2(c * offsets[i].x - s * offsets[i].y, s * offsets[i].x + c * offsets[i].y);
+    }
 
-    // render textured quad
-    this->shader.SetVector3f("spriteColor", color);
+    // same winding as the original unit quad, texture coordinates span the region's uv rectangle
+    const glm::vec4& uv = texture.UV;
+    this->vertices.push_back({ corners[2], glm::vec2(uv.x, uv.w), color });
+    this->vertices.push_back({ corners[1], glm::vec2(uv.z, uv.y), color });
+    this->vertices.push_back({ corners[0], glm::vec2(uv.x, uv.y), color });
 
-    glActiveTexture(GL_TEXTURE0);
-    texture.Bind();
+    this->vertices.push_back({ corners[2], glm::vec2(uv.x, uv.w), color });
+    this->vertices.push_back({ corners[3], glm::vec2(uv.z, uv.w), color });
+    this->vertices.push_back({ corners[1], glm::vec2(uv.z, uv.y), color });
 
-    glBindVertexArray(this->quadVAO);
-    glDrawArrays(GL_TRIANGLES, 0, 6);
-    glBindVertexArray(0);
+    if(!this->batching)
+        this->Flush();
 }
 
-void SpriteRenderer::initRenderData() {
-    unsigned int VBO;
+unsigned int SpriteRenderer::Flush() {
+    if(this->vertices.empty())
+        return 0;
 
-    float vertices[] = {
-        // pos          // tex
-        0.0f, 1.0f,     0.0f, 1.0f,
-        1.0f, 0.0f,     1.0f, 0.0f,
-        0.0f, 0.0f,     0.0f, 0.0f,
+    this->shader.Use();
+    GLState::ActiveTexture(0);
+    GLState::BindTexture(this->batchTexture);
 
-        0.0f, 1.0f,     0.0f, 1.0f,
-        1.0f, 1.0f,     1.0f, 1.0f,
-        1.0f, 0.0f,     1.0f, 0.0f,
-    };
+    unsigned int count = this->vertices.size();
+    unsigned int offset = StreamBuffer::Write(this->vertices.data(), count * sizeof(SpriteVertex), sizeof(SpriteVertex));
+    this->vertices.clear();
+    if(offset == STREAM_BUFFER_INVALID)
+        return 0;
 
-    glGenVertexArrays(1, &this->quadVAO);
-    glGenBuffers(1, &VBO);
+    GLState::BindVertexArray(this->quadVAO);
+    glDrawArrays(GL_TRIANGLES, offset / sizeof(SpriteVertex), count);
+    return 1;
+}
+
+Shader& SpriteRenderer::GetShader() {
+    return this->shader;
+}
 
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+void SpriteRenderer::initRenderData() {
+    // the vertices live in the shared stream buffer, each batch is drawn from the offset it was written to
+    glGenVertexArrays(1, &this->quadVAO);
+    GLState::BindVertexArray(this->quadVAO);
+    GLState::BindBuffer(GL_ARRAY_BUFFER, StreamBuffer::ID);
+    this->vertices.reserve(INITIAL_BATCH_SPRITES * 6);
 
-    glBindVertexArray(this->quadVAO);
+    // <vec2 position, vec2 texCoords>
     glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
+    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, sizeof(SpriteVertex), (void*)0);
+    // <vec3 color>
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(SpriteVertex), (void*)offsetof(SpriteVertex, Color));
 }
\ No newline at end of file
@@ -1,6 +1,8 @@
 #ifndef SPRITE_RENDERER_H
 #define SPRITE_RENDERER_H
 
+#include <vector>
+
 #include <glad/glad.h>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
@@ -8,17 +10,41 @@
 #include "texture.h"
 #include "shader.h"
 
+// a single vertex of a batched sprite quad, already transformed to world space
+struct SpriteVertex {
+    glm::vec2 Position;
+    glm::vec2 TexCoords;
+    glm::vec3 Color;
+};
+
+// SpriteRenderer draws textured quads. Sprites drawn between Begin() and End()
+// are collected into a CPU vertex buffer and submitted with a single draw call
+// per texture change, outside of a batch every sprite is drawn immediately.
+// The vertices of every draw call are written to the StreamBuffer.
 class SpriteRenderer {
 public:
     SpriteRenderer(Shader& shader);
     ~SpriteRenderer();
-    void DrawSprite(Texture2D& texture, glm::vec2 position,
-        glm::vec2 size = glm::vec2(10.0f, 10.0f), float rotate = 0.0f, 
+    // starts collecting sprites into the vertex batch
+    void Begin();
+    // draws the remaining batched sprites and leaves batching mode
+    void End();
+    // draws all sprites collected so far with a single draw call, returns the number of draw calls issued
+    unsigned int Flush();
+    void DrawSprite(TextureRegion& texture, glm::vec2 position,
+        glm::vec2 size = glm::vec2(10.0f, 10.0f), float rotate = 0.0f,
         glm::vec3 color = glm::vec3(1.0f));
+    // shader all sprites are drawn with
+    Shader& GetShader();
 private:
     // render state
     Shader shader;
-    unsigned int quadVAO;
+    unsigned int quadVAO; // reads from the StreamBuffer
+
+    // batch state
+    std::vector<SpriteVertex> vertices;
+    unsigned int batchTexture;
+    bool batching;
 
     void initRenderData();
 };
@@ -0,0 +1,119 @@
+#include "stream_buffer.h"
+#include "gl_state.h"
+
+#include <cstring>
+#include <iostream>
+
+// how long a single wait on a region fence may block before it is retried (1 ms)
+const GLuint64 FENCE_TIMEOUT = 1000000;
+
+// instantiate static variables
+unsigned int StreamBuffer::ID = 0;
+bool StreamBuffer::Persistent = false;
+unsigned int StreamBuffer::Waits = 0;
+unsigned int StreamBuffer::regionSize = 0;
+unsigned int StreamBuffer::region = 0;
+unsigned int StreamBuffer::head = 0;
+unsigned char* StreamBuffer::mapped = nullptr;
+GLsync StreamBuffer::fences[STREAM_BUFFER_REGIONS] = {};
+
+void StreamBuffer::Init(unsigned int regionSize, bool allowPersistent) {
+    StreamBuffer::regionSize = regionSize;
+    region = head = 0;
+    GLsizeiptr size = static_cast<GLsizeiptr>(regionSize) * STREAM_BUFFER_REGIONS;
+
+    glGenBuffers(1, &ID);
+    GLState::BindBuffer(GL_ARRAY_BUFFER, ID);
+
+    // buffer storage is core since GL 4.4, the game only requires 3.3
+    Persistent = allowPersistent && GLAD_GL_VERSION_4_4 && glBufferStorage;
+    if(Persistent) {
+        GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glBufferStorage(GL_ARRAY_BUFFER, size, NULL, flags);
+        mapped = static_cast<unsigned char*>(glMapBufferRange(GL_ARRAY_BUFFER, 0, size, flags));
+        if(!mapped) {
+            std::cout << "ERROR::STREAM_BUFFER: Failed to map buffer, falling back to orphaning" << std::endl;
+            // storage is immutable, start over with a new buffer
+            GLState::DeleteBuffer(ID);
+            glGenBuffers(1, &ID);
+            GLState::BindBuffer(GL_ARRAY_BUFFER, ID);
+            Persistent = false;
+        }
+    }
+    if(!Persistent)
+        glBufferData(GL_ARRAY_BUFFER, size, NULL, GL_STREAM_DRAW);
+}
+
+unsigned int StreamBuffer::Write(const void* data, unsigned int size, unsigned int alignment) {
+    if(size + alignment > regionSize) {
+        std::cout << "ERROR::STREAM_BUFFER: Write of " << size << " bytes does not fit into a region" << std::endl;
+        return STREAM_BUFFER_INVALID;
+    }
+
+    unsigned int offset = (head + alignment - 1) / alignment * alignment;
+    // the current region is full, continue in the next one (as if a frame had ended)
+    if(offset + size > (region + 1) * regionSize) {
+        nextRegion();
+        offset = (head + alignment - 1) / alignment * alignment;
+    }
+
+    if(Persistent) {
+        std::memcpy(mapped + offset, data, size);
+    } else {
+        // the range was never written since the last orphan, nothing can be reading it
+        GLState::BindBuffer(GL_ARRAY_BUFFER, ID);
+        void* ptr = glMapBufferRange(GL_ARRAY_BUFFER, offset, size,
+            GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+        std::memcpy(ptr, data, size);
+        glUnmapBuffer(GL_ARRAY_BUFFER);
+    }
+    head = offset + size;
+    return offset;
+}
+
+void StreamBuffer::EndFrame() {
+    nextRegion();
+}
+
+void StreamBuffer::Clear() {
+    for(unsigned int i = 0; i < STREAM_BUFFER_REGIONS; i++) {
+        if(fences[i])
+            glDeleteSync(fences[i]);
+        fences[i] = nullptr;
+    }
+    if(mapped) {
+        GLState::BindBuffer(GL_ARRAY_BUFFER, ID);
+        glUnmapBuffer(GL_ARRAY_BUFFER);
+        mapped = nullptr;
+    }
+    GLState::DeleteBuffer(ID);
+    ID = 0;
+}
+
+void StreamBuffer::nextRegion() {
+    if(Persistent)
+        fences[region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+    region = (region + 1) % STREAM_BUFFER_REGIONS;
+    head = region * regionSize;
+
+    if(Persistent) {
+        GLsync fence = fences[region];
+        if(!fence)
+            return;
+        // usually signaled long ago, the GPU is rarely more than a frame behind
+        GLenum result = glClientWaitSync(fence, 0, 0);
+        if(result == GL_TIMEOUT_EXPIRED) {
+            Waits++;
+            do
+                result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, FENCE_TIMEOUT);
+            while(result == GL_TIMEOUT_EXPIRED);
+        }
+        glDeleteSync(fence);
+        fences[region] = nullptr;
+    } else if(region == 0) {
+        // orphan the storage, draws still reading the old one keep it alive in the driver
+        GLState::BindBuffer(GL_ARRAY_BUFFER, ID);
+        glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(regionSize) * STREAM_BUFFER_REGIONS, NULL, GL_STREAM_DRAW);
+    }
+}
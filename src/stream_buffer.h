@@ -0,0 +1,54 @@
+#ifndef STREAM_BUFFER_H
+#define STREAM_BUFFER_H
+
+#include <glad/glad.h>
+
+// number of frames the ring buffer is split into, the CPU can write one frame
+// while the GPU still reads the others
+const unsigned int STREAM_BUFFER_REGIONS = 3;
+// returned by Write() if the data can never fit into a region
+const unsigned int STREAM_BUFFER_INVALID = 0xFFFFFFFF;
+
+// A static singleton StreamBuffer class that hosts all transient vertex data
+// written every frame (sprite batches, particles, text). It is one GL_ARRAY_BUFFER
+// used as a ring of STREAM_BUFFER_REGIONS per frame regions:
+//   - with GL 4.4 the buffer is allocated with glBufferStorage and stays mapped
+//     (persistent + coherent), writes are a plain memcpy. Before a region is
+//     reused the CPU waits on the fence placed when the GPU was given its data.
+//   - on GL 3.3 the buffer is orphaned whenever the ring wraps around and every
+//     write maps its range unsynchronized, so the driver never has to wait for
+//     draws that still read the old storage.
+// Vertex arrays point their attributes at ID with offset 0 and draw with the
+// first vertex returned by Write(). All functions and state are static.
+class StreamBuffer {
+public:
+    // the GL buffer object
+    static unsigned int ID;
+    // true if the buffer is persistently mapped
+    static bool Persistent;
+    // number of times the CPU had to wait for the GPU before reusing a region
+    static unsigned int Waits;
+
+    // allocates the buffer, allowPersistent = false forces the GL 3.3 path
+    static void Init(unsigned int regionSize, bool allowPersistent = true);
+    // copies size bytes into the current region at an offset that is a multiple of
+    // alignment (the vertex size), returns that offset or STREAM_BUFFER_INVALID
+    static unsigned int Write(const void* data, unsigned int size, unsigned int alignment);
+    // closes the region of the current frame, data written so far may still be read by the GPU
+    static void EndFrame();
+    // deletes the buffer and its fences
+    static void Clear();
+private:
+    StreamBuffer() {}
+
+    static unsigned int regionSize;
+    static unsigned int region; // region written this frame
+    static unsigned int head;   // next free byte of the buffer
+    static unsigned char* mapped;
+    static GLsync fences[STREAM_BUFFER_REGIONS];
+
+    // fences the current region and moves on to the next one, waiting until the GPU is done with it
+    static void nextRegion();
+};
+
+#endif
@@ -1,7 +1,5 @@
 #include <iostream>
 
-#include <glm/gtc/matrix_transform.hpp>
-
 #include "ft2build.h"
 #include <freetype/freetype.h>
 #include <freetype/ftoutln.h>
@@ -9,24 +7,23 @@
 
 #include "text_renderer.h"
 #include "resource_manager.h"
+#include "gl_state.h"
+#include "stream_buffer.h"
+
+constexpr UniformName UNIFORM_TEXT_COLOR("textColor");
 
 
-TextRenderer::TextRenderer(unsigned int width, unsigned int height)
+TextRenderer::TextRenderer()
 {
-    // load and configure shader
+    // load and configure shader (the projection comes from the per frame uniform block)
     this->TextShader = ResourceManager::LoadShader("shaders/text_2d.vs", "shaders/text_2d.fs", nullptr, "text");
-    this->TextShader.SetMatrix4("projection", glm::ortho(0.0f, static_cast<float>(width), static_cast<float>(height), 0.0f), true);
-    this->TextShader.SetInteger("text", 0);
-    // configure VAO/VBO for texture quads
+    this->TextShader.SetInteger("text", 0, true);
+    // configure VAO for texture quads, the vertices are streamed
     glGenVertexArrays(1, &this->VAO);
-    glGenBuffers(1, &this->VBO);
-    glBindVertexArray(this->VAO);
-    glBindBuffer(GL_ARRAY_BUFFER, this->VBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(float) * 6 * 4, NULL, GL_DYNAMIC_DRAW);
+    GLState::BindVertexArray(this->VAO);
+    GLState::BindBuffer(GL_ARRAY_BUFFER, StreamBuffer::ID);
     glEnableVertexAttribArray(0);
     glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), 0);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
 }
 
 void TextRenderer::Load(std::string font, unsigned int fontSize)
@@ -57,7 +54,7 @@ void TextRenderer::Load(std::string font, unsigned int fontSize)
         // generate texture
         unsigned int texture;
         glGenTextures(1, &texture);
-        glBindTexture(GL_TEXTURE_2D, texture);
+        GLState::BindTexture(texture);
         glTexImage2D(
             GL_TEXTURE_2D,
             0,
@@ -84,7 +81,6 @@ void TextRenderer::Load(std::string font, unsigned int fontSize)
         };
         Characters.insert(std::pair<char, Character>(c, character));
     }
-    glBindTexture(GL_TEXTURE_2D, 0);
     // destroy FreeType once we're finished
     FT_Done_Face(face);
     FT_Done_FreeType(ft);
@@ -92,13 +88,8 @@ void TextRenderer::Load(std::string font, unsigned int fontSize)
 
 void TextRenderer::RenderText(std::string text, float x, float y, float scale, glm::vec3 color)
 {
-    // activate corresponding render state	
-    this->TextShader.Use();
-    this->TextShader.SetVector3f("textColor", color);
-    glActiveTexture(GL_TEXTURE0);
-    glBindVertexArray(this->VAO);
-
-    // iterate through all characters
+    // build the quads of all characters first, so they are uploaded at once
+    this->vertices.clear();
     std::string::const_iterator c;
     for (c = text.begin(); c != text.end(); c++)
     {
@@ -109,8 +100,7 @@ void TextRenderer::RenderText(std::string text, float x, float y, float scale, g
 
         float w = ch.Size.x * scale;
         float h = ch.Size.y * scale;
-        // update VBO for each character
-        float vertices[6][4] = {
+        glm::vec4 quad[6] = {
             { xpos,     ypos + h,   0.0f, 1.0f },
             { xpos + w, ypos,       1.0f, 0.0f },
             { xpos,     ypos,       0.0f, 0.0f },
@@ -119,17 +109,27 @@ void TextRenderer::RenderText(std::string text, float x, float y, float scale, g
             { xpos + w, ypos + h,   1.0f, 1.0f },
             { xpos + w, ypos,       1.0f, 0.0f }
         };
-        // render glyph texture over quad
-        glBindTexture(GL_TEXTURE_2D, ch.TextureID);
-        // update content of VBO memory
-        glBindBuffer(GL_ARRAY_BUFFER, this->VBO);
-        glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(vertices), vertices); // be sure to use glBufferSubData and not glBufferData
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
-        // render quad
-        glDrawArrays(GL_TRIANGLES, 0, 6);
+        this->vertices.insert(this->vertices.end(), quad, quad + 6);
         // now advance cursors for next glyph
         x += (ch.Advance >> 6) * scale; // bitshift by 6 to get value in pixels (1/64th times 2^6 = 64)
     }
-    glBindVertexArray(0);
-    glBindTexture(GL_TEXTURE_2D, 0);
+    if (this->vertices.empty())
+        return;
+    unsigned int offset = StreamBuffer::Write(this->vertices.data(), this->vertices.size() * sizeof(glm::vec4), sizeof(glm::vec4));
+    if (offset == STREAM_BUFFER_INVALID)
+        return;
+
+    // activate corresponding render state	
+    this->TextShader.Use();
+    this->TextShader.SetVector3f(UNIFORM_TEXT_COLOR, color);
+    GLState::ActiveTexture(0);
+    GLState::BindVertexArray(this->VAO);
+
+    // every glyph has its own texture, render each quad from the uploaded vertices
+    unsigned int first = offset / sizeof(glm::vec4);
+    for (c = text.begin(); c != text.end(); c++, first += 6)
+    {
+        GLState::BindTexture(Characters[*c].TextureID);
+        glDrawArrays(GL_TRIANGLES, first, 6);
+    }
 }
\ No newline at end of file
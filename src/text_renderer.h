@@ -2,6 +2,7 @@
 #define TEXT_RENDERER_H
 
 #include <map>
+#include <vector>
 
 #include <glad/glad.h>
 #include <glm/glm.hpp>
@@ -25,14 +26,16 @@ public:
     // hold the precompiled characters
     std::map<char, Character> Characters;
     Shader TextShader;
-    TextRenderer(unsigned int width, unsigned int height);
+    TextRenderer();
     // precompiles a list of characters from the given font
     void Load(std::string font, unsigned int fontSize);
     // renders a string of text using the precompiled list of characters
     void RenderText(std::string text, float x, float y, float scale, glm::vec3 color = glm::vec3(1.0f));
 private:
     // render state
-    unsigned int VAO, VBO;
+    unsigned int VAO; // reads from the StreamBuffer
+    // quads of the text being rendered, <vec2 pos, vec2 texCoords>
+    std::vector<glm::vec4> vertices;
 };
 
 #endif
\ No newline at end of file
@@ -1,19 +1,20 @@
 #include <iostream>
 
 #include "texture.h"
+#include "gl_state.h"
 
 Texture2D::Texture2D():
-    Width(0), Height(0), Internal_Format(GL_RGB), Image_Format(GL_RGB), Wrap_S(GL_REPEAT),
-    Wrap_T(GL_REPEAT), Filter_Min(GL_LINEAR), Filter_Max(GL_LINEAR) {
-        glGenTextures(1, &this->ID);
-}
+    ID(0), Width(0), Height(0), Internal_Format(GL_RGB), Image_Format(GL_RGB), Wrap_S(GL_REPEAT),
+    Wrap_T(GL_REPEAT), Filter_Min(GL_LINEAR), Filter_Max(GL_LINEAR) {}
 
 void Texture2D::Generate(unsigned int width, unsigned int height, unsigned char* data) {
+    if(!this->ID)
+        glGenTextures(1, &this->ID);
     this->Width = width;
     this->Height = height;
 
     // create texture
-    glBindTexture(GL_TEXTURE_2D, this->ID);
+    GLState::BindTexture(this->ID);
     glTexImage2D(GL_TEXTURE_2D, 0, this->Internal_Format, width, height, 0, this->Image_Format, GL_UNSIGNED_BYTE, data);
 
     // set texture wrap and filter modes
@@ -21,11 +22,8 @@ void Texture2D::Generate(unsigned int width, unsigned int height, unsigned char*
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, this->Wrap_T);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, this->Filter_Min);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, this->Filter_Max);
-
-    // unbind texture
-    glBindTexture(GL_TEXTURE_2D, 0);
 }
 
 void Texture2D::Bind() const {
-    glBindTexture(GL_TEXTURE_2D, this->ID);
+    GLState::BindTexture(this->ID);
 }
@@ -2,7 +2,10 @@
 #define TEXTURE_H
 
 #include <glad/glad.h>
+#include <glm/glm.hpp>
 
+// Texture2D holds the description of a 2D texture. The GL texture object is only
+// created by Generate(), so constructing or copying a Texture2D never calls into GL.
 class Texture2D {
 public:
     unsigned int ID;
@@ -18,8 +21,22 @@ public:
 
     Texture2D();
 
+    // creates the GL texture object (on first use) and uploads the image
     void Generate(unsigned int width, unsigned int height, unsigned char* data);
     void Bind() const;
 };
 
+// a sub-rectangle of a texture. textures packed into an atlas all
+// reference the same atlas page and only differ in their uv rectangle
+struct TextureRegion {
+    Texture2D Texture;
+    glm::vec4 UV; // <vec2 min, vec2 max>
+
+    TextureRegion() : Texture(), UV(0.0f, 0.0f, 1.0f, 1.0f) {}
+    TextureRegion(Texture2D texture, glm::vec4 uv = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f)) : Texture(texture), UV(uv) {}
+};
+
+// index of a texture region in the ResourceManager's texture table, 0 is an empty texture
+typedef unsigned int TextureHandle;
+
 #endif
\ No newline at end of file
@@ -0,0 +1,93 @@
+#include "texture_atlas.h"
+
+#include <algorithm>
+#include <cstring>
+
+TextureAtlas::TextureAtlas(unsigned int pageSize, unsigned int padding)
+    : pageSize(pageSize), padding(padding) {}
+
+void TextureAtlas::Add(std::string name, unsigned int width, unsigned int height, const unsigned char* pixels) {
+    Image image;
+    image.Name = name;
+    image.Width = width;
+    image.Height = height;
+    image.Pixels.assign(pixels, pixels + width * height * 4);
+    this->images.push_back(image);
+}
+
+bool TextureAtlas::Pack() {
+    this->Pages.clear();
+    this->Regions.clear();
+
+    // tallest images first, so every shelf wastes as little height as possible
+    std::vector<Image*> order;
+    for(Image& image : this->images)
+        order.push_back(&image);
+    std::stable_sort(order.begin(), order.end(), [](const Image* a, const Image* b) { return a->Height > b->Height; });
+
+    std::vector<unsigned int> pageHeights; // used height of each page
+    unsigned int page = 0, cursorX = 0, cursorY = 0, shelfHeight = 0;
+    pageHeights.push_back(0);
+
+    for(Image* image : order) {
+        unsigned int width = image->Width + 2 * this->padding;
+        unsigned int height = image->Height + 2 * this->padding;
+        if(width > this->pageSize || height > this->pageSize)
+            return false;
+
+        // start a new shelf
+        if(cursorX + width > this->pageSize) {
+            cursorY += shelfHeight;
+            cursorX = 0;
+            shelfHeight = 0;
+        }
+        // start a new page
+        if(cursorY + height > this->pageSize) {
+            page++;
+            cursorX = cursorY = shelfHeight = 0;
+            pageHeights.push_back(0);
+        }
+
+        this->Regions[image->Name] = { page, cursorX + this->padding, cursorY + this->padding, image->Width, image->Height };
+        cursorX += width;
+        shelfHeight = std::max(shelfHeight, height);
+        pageHeights[page] = std::max(pageHeights[page], cursorY + shelfHeight);
+    }
+
+    // pages are only as high as they need to be
+    for(unsigned int height : pageHeights) {
+        Page p;
+        p.Width = this->pageSize;
+        p.Height = height;
+        p.Pixels.assign(p.Width * p.Height * 4, 0);
+        this->Pages.push_back(p);
+    }
+
+    for(Image& image : this->images)
+        this->blit(image, this->Regions[image.Name]);
+
+    return true;
+}
+
+glm::vec4 TextureAtlas::UV(const Region& region) const {
+    const Page& page = this->Pages[region.Page];
+    return glm::vec4(
+        region.X / static_cast<float>(page.Width), region.Y / static_cast<float>(page.Height),
+        (region.X + region.Width) / static_cast<float>(page.Width), (region.Y + region.Height) / static_cast<float>(page.Height));
+}
+
+void TextureAtlas::blit(const Image& image, const Region& region) {
+    Page& page = this->Pages[region.Page];
+    int pad = this->padding;
+
+    // copy the image rows, clamping source coordinates so the border pixels are extruded into the padding
+    for(int y = -pad; y < static_cast<int>(image.Height) + pad; y++) {
+        int srcY = std::min(std::max(y, 0), static_cast<int>(image.Height) - 1);
+        for(int x = -pad; x < static_cast<int>(image.Width) + pad; x++) {
+            int srcX = std::min(std::max(x, 0), static_cast<int>(image.Width) - 1);
+            const unsigned char* src = &image.Pixels[(srcY * image.Width + srcX) * 4];
+            unsigned char* dst = &page.Pixels[((region.Y + y) * page.Width + region.X + x) * 4];
+            std::memcpy(dst, src, 4);
+        }
+    }
+}
\ No newline at end of file
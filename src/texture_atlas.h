@@ -0,0 +1,52 @@
+#ifndef TEXTURE_ATLAS_H
+#define TEXTURE_ATLAS_H
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+// TextureAtlas packs many small RGBA images into one or a few large atlas pages
+// using a simple shelf packer. It only works on pixel data and never touches
+// OpenGL, so it can be used at load time as well as from an offline tool.
+class TextureAtlas {
+public:
+    // location of a packed image
+    struct Region {
+        unsigned int Page;
+        unsigned int X, Y, Width, Height;
+    };
+    // a packed atlas page (RGBA8, rows from top to bottom as loaded by stb_image)
+    struct Page {
+        unsigned int Width, Height;
+        std::vector<unsigned char> Pixels;
+    };
+
+    std::vector<Page> Pages;
+    std::map<std::string, Region> Regions;
+
+    // padding is the number of border pixels extruded around every image to avoid filtering bleed
+    TextureAtlas(unsigned int pageSize = 2048, unsigned int padding = 2);
+    // adds an RGBA8 image to be packed, the pixel data is copied
+    void Add(std::string name, unsigned int width, unsigned int height, const unsigned char* pixels);
+    // packs all added images into pages, returns false if an image does not fit on a page
+    bool Pack();
+    // uv sub-rectangle <vec2 min, vec2 max> of a packed image on its page
+    glm::vec4 UV(const Region& region) const;
+private:
+    struct Image {
+        std::string Name;
+        unsigned int Width, Height;
+        std::vector<unsigned char> Pixels;
+    };
+
+    unsigned int pageSize;
+    unsigned int padding;
+    std::vector<Image> images;
+
+    // copies an image into its page and extrudes its border into the padding
+    void blit(const Image& image, const Region& region);
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,76 @@
+#include "worker_pool.h"
+
+WorkerPool::WorkerPool(unsigned int threads)
+    : count(0), batch(0), next(0), finished(0), busy(0), quit(false) {
+    for(unsigned int i = 0; i < threads; i++)
+        this->threads.emplace_back(&WorkerPool::work, this, i + 1);
+}
+
+WorkerPool::~WorkerPool() {
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->quit = true;
+    }
+    this->wake.notify_all();
+    for(std::thread& thread : this->threads)
+        thread.join();
+}
+
+unsigned int WorkerPool::Threads() const {
+    return this->threads.size();
+}
+
+void WorkerPool::Dispatch(unsigned int count, WorkerJob job) {
+    {
+        std::unique_lock<std::mutex> lock(this->mutex);
+        // a worker may still be leaving the previous batch, it must not see a half written one
+        this->done.wait(lock, [this]() { return this->busy == 0; });
+        this->job = std::move(job);
+        this->count = count;
+        this->next = 0;
+        this->finished = 0;
+        this->batch++;
+    }
+    this->wake.notify_all();
+}
+
+void WorkerPool::Wait() {
+    while(this->runNext(0))
+        ;
+    std::unique_lock<std::mutex> lock(this->mutex);
+    this->done.wait(lock, [this]() { return this->finished == this->count; });
+}
+
+void WorkerPool::work(unsigned int thread) {
+    unsigned int seen = 0;
+    for(;;) {
+        {
+            std::unique_lock<std::mutex> lock(this->mutex);
+            this->wake.wait(lock, [this, seen]() { return this->quit || this->batch != seen; });
+            if(this->quit)
+                return;
+            seen = this->batch;
+            this->busy++;
+        }
+        while(this->runNext(thread))
+            ;
+        {
+            std::lock_guard<std::mutex> lock(this->mutex);
+            this->busy--;
+        }
+        this->done.notify_all();
+    }
+}
+
+bool WorkerPool::runNext(unsigned int thread) {
+    unsigned int index = this->next++;
+    if(index >= this->count)
+        return false;
+    this->job(index, thread);
+    if(++this->finished == this->count) {
+        // notify under the lock, Wait() may be between its check and going to sleep
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->done.notify_all();
+    }
+    return true;
+}
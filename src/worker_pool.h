@@ -0,0 +1,49 @@
+#ifndef WORKER_POOL_H
+#define WORKER_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// job of a dispatch, called with the job index and the index of the thread
+// running it (0 is the thread calling Wait(), workers are 1..Threads())
+typedef std::function<void(unsigned int job, unsigned int thread)> WorkerJob;
+
+// WorkerPool runs batches of independent jobs on a fixed set of threads.
+// Dispatch() hands a batch to the workers and returns immediately, so the
+// calling thread can do other work until it calls Wait(). Wait() runs the
+// jobs no worker has picked up yet and returns once the whole batch is done.
+// Only one batch is in flight at a time and both calls belong to one thread.
+class WorkerPool {
+public:
+    // threads is the number of worker threads, with 0 every job runs inside Wait()
+    WorkerPool(unsigned int threads);
+    ~WorkerPool();
+    unsigned int Threads() const;
+    // starts count jobs
+    void Dispatch(unsigned int count, WorkerJob job);
+    // helps running the dispatched jobs until all of them are done
+    void Wait();
+private:
+    std::vector<std::thread> threads;
+    std::mutex mutex;
+    std::condition_variable wake; // a batch was dispatched or the pool shuts down
+    std::condition_variable done; // a batch finished or a worker went idle
+    // current batch, only written while no worker is busy
+    WorkerJob job;
+    unsigned int count;
+    unsigned int batch; // incremented for every dispatch
+    std::atomic<unsigned int> next;
+    std::atomic<unsigned int> finished;
+    unsigned int busy;  // workers running jobs of the current batch
+    bool quit;
+
+    void work(unsigned int thread);
+    // runs the next job of the batch, returns false if there is none left
+    bool runNext(unsigned int thread);
+};
+
+#endif